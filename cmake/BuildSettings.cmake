@@ -20,3 +20,77 @@ FetchContent_Declare(
 # For Windows: Prevent overriding the parent project's compiler/linker settings
 set(gtest_force_shared_crt ON CACHE BOOL "" FORCE)
 FetchContent_MakeAvailable(googletest)
+
+# Declare dependency on Google Benchmark (for statement_bench)
+# See https://github.com/google/benchmark#usage-with-cmake
+FetchContent_Declare(
+    googlebenchmark
+    URL https://github.com/google/benchmark/archive/refs/tags/v1.8.3.zip
+)
+# Build only the library (against the GoogleTest above rather than its own)
+set(BENCHMARK_ENABLE_TESTING OFF CACHE BOOL "" FORCE)
+set(BENCHMARK_ENABLE_INSTALL OFF CACHE BOOL "" FORCE)
+FetchContent_MakeAvailable(googlebenchmark)
+
+# Optimizations for the release builds of our own targets (see CMakePresets.json),
+# set after the dependencies above so as not to apply to them
+option(STATEMENT_LTO "Build with link-time optimization" OFF)
+set(STATEMENT_PGO "" CACHE STRING "Profile-guided optimization: generate (to train) or use (the profile)")
+set_property(CACHE STATEMENT_PGO PROPERTY STRINGS "" generate use)
+set(STATEMENT_PGO_DIR "${CMAKE_BINARY_DIR}/pgo-profile" CACHE PATH "Directory of the PGO profile")
+
+if (STATEMENT_LTO)
+    include(CheckIPOSupported)
+    check_ipo_supported(RESULT lto_supported OUTPUT lto_output LANGUAGES CXX)
+    if (NOT lto_supported)
+        message(FATAL_ERROR "Link-time optimization is not supported: ${lto_output}")
+    endif ()
+    set(CMAKE_INTERPROCEDURAL_OPTIMIZATION ON)
+endif ()
+
+if (STATEMENT_PGO)
+    if (NOT STATEMENT_PGO MATCHES "^(generate|use)$")
+        message(FATAL_ERROR "STATEMENT_PGO must be generate or use: ${STATEMENT_PGO}")
+    endif ()
+
+    if (CMAKE_CXX_COMPILER_ID STREQUAL "GNU")
+        # make the profile independent of the build directory
+        # so that the profile trained in one can be used by another
+        add_compile_options(-fprofile-prefix-path=${CMAKE_BINARY_DIR})
+        if (STATEMENT_PGO STREQUAL "generate")
+            # the statements are also rendered in parallel
+            add_compile_options(-fprofile-generate=${STATEMENT_PGO_DIR} -fprofile-update=atomic)
+            add_link_options(-fprofile-generate=${STATEMENT_PGO_DIR})
+        else ()
+            # with warnings (rather than errors) for the functions changed since trained
+            add_compile_options(
+                -fprofile-use=${STATEMENT_PGO_DIR} -fprofile-correction
+                -Wno-missing-profile -Wno-error=coverage-mismatch)
+            add_link_options(-fprofile-use=${STATEMENT_PGO_DIR})
+        endif ()
+    elseif (CMAKE_CXX_COMPILER_ID MATCHES "Clang")
+        if (STATEMENT_PGO STREQUAL "generate")
+            find_program(LLVM_PROFDATA NAMES llvm-profdata REQUIRED)
+            add_compile_options(-fprofile-generate=${STATEMENT_PGO_DIR})
+            add_link_options(-fprofile-generate=${STATEMENT_PGO_DIR})
+        else ()
+            add_compile_options(-fprofile-use=${STATEMENT_PGO_DIR}/default.profdata -Wno-profile-instr-unprofiled)
+            add_link_options(-fprofile-use=${STATEMENT_PGO_DIR}/default.profdata)
+        endif ()
+    else ()
+        message(FATAL_ERROR "Profile-guided optimization is not supported with ${CMAKE_CXX_COMPILER_ID}")
+    endif ()
+
+    if (STATEMENT_PGO STREQUAL "use" AND NOT EXISTS ${STATEMENT_PGO_DIR})
+        message(WARNING "No PGO profile in ${STATEMENT_PGO_DIR}; build the pgo-train target first")
+    endif ()
+endif ()
+
+# The performance regression tests (see src/statement_perf_test.cpp), left out of the default
+# build and `ctest` as they time the machine, checked against the baselines of the throughput
+# recorded on it and of the allocations committed along with the sources
+option(STATEMENT_PERF_TESTS "Build and register the performance regression tests" OFF)
+set(STATEMENT_PERF_BASELINE "${CMAKE_BINARY_DIR}/statement_perf_baseline.txt"
+    CACHE FILEPATH "Baseline of the throughput of the performance regression tests")
+set(STATEMENT_PERF_ALLOCATIONS "${PROJECT_SOURCE_DIR}/src/statement_perf_allocations.txt"
+    CACHE FILEPATH "Baseline of the allocations of the performance regression tests")
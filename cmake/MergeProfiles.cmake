@@ -0,0 +1,10 @@
+# Merges the raw profiles written by the Clang-instrumented build in PGO_DIR
+# into PGO_DIR/default.profdata with LLVM_PROFDATA (see the pgo-train target)
+file(GLOB raw_profiles "${PGO_DIR}/*.profraw")
+if (NOT raw_profiles)
+    message(FATAL_ERROR "No raw profiles in ${PGO_DIR}")
+endif ()
+execute_process(
+    COMMAND ${LLVM_PROFDATA} merge -output=${PGO_DIR}/default.profdata ${raw_profiles}
+    COMMAND_ERROR_IS_FATAL ANY
+)
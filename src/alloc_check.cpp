@@ -0,0 +1,97 @@
+#include "pch.h"
+
+#include "alloc_check.h"
+
+#if defined(_WIN32)
+#include <malloc.h>
+#endif
+
+namespace {
+
+std::atomic<std::uint64_t> g_allocations{0};
+std::atomic<std::uint64_t> g_deallocations{0};
+std::atomic<std::uint64_t> g_bytes{0};
+
+void count_allocation(std::size_t size) noexcept
+{
+    g_allocations.fetch_add(1, std::memory_order_relaxed);
+    g_bytes.fetch_add(size, std::memory_order_relaxed);
+}
+
+void count_deallocation(void* p) noexcept
+{
+    if (p) { g_deallocations.fetch_add(1, std::memory_order_relaxed); }
+}
+
+// Calls `allocate` until it succeeds, calling the new handler in between,
+// or throws `std::bad_alloc` if there is no new handler (as the default `operator new` does).
+template<typename F>
+void* allocate_or_throw(F allocate)
+{
+    while (true) {
+        if (auto p = allocate()) { return p; }
+        const auto handler = std::get_new_handler();
+        if (!handler) { throw std::bad_alloc{}; }
+        handler();
+    }
+}
+
+}
+
+AllocationStats allocation_stats() noexcept
+{
+    return {
+        .allocations = g_allocations.load(std::memory_order_relaxed),
+        .deallocations = g_deallocations.load(std::memory_order_relaxed),
+        .bytes = g_bytes.load(std::memory_order_relaxed),
+    };
+}
+
+// The other forms (of arrays and non-throwing) forward to these by default.
+
+void* operator new(std::size_t size)
+{
+    count_allocation(size);
+    return allocate_or_throw([size] { return std::malloc(size == 0 ? 1 : size); });
+}
+
+void* operator new(std::size_t size, std::align_val_t alignment)
+{
+    count_allocation(size);
+    const auto align = static_cast<std::size_t>(alignment);
+    return allocate_or_throw([size, align]
+    {
+#if defined(_WIN32)
+        return _aligned_malloc(size == 0 ? 1 : size, align);
+#else
+        // rounded up to a multiple of the alignment as `std::aligned_alloc` requires
+        return std::aligned_alloc(align, (std::max<std::size_t>(size, 1) + align - 1) / align * align);
+#endif
+    });
+}
+
+void operator delete(void* p) noexcept
+{
+    count_deallocation(p);
+    std::free(p);
+}
+
+void operator delete(void* p, std::align_val_t) noexcept
+{
+    count_deallocation(p);
+#if defined(_WIN32)
+    _aligned_free(p);
+#else
+    std::free(p);
+#endif
+}
+
+void operator delete(void* p, std::size_t) noexcept
+{
+    ::operator delete(p);
+}
+
+void operator delete(void* p, std::size_t, std::align_val_t alignment) noexcept
+{
+    ::operator delete(p, alignment);
+}
@@ -0,0 +1,42 @@
+#pragma once
+
+// Heap allocations counted process-wide by the global `operator new` and `operator delete`
+// replaced in `alloc_check.cpp`, which is linked (like `crt_check.cpp`) into the tests and
+// the benchmarks only; counting costs an atomic increment per allocation.
+struct AllocationStats
+{
+    std::uint64_t allocations = 0;
+    std::uint64_t deallocations = 0;
+    // bytes requested by the allocations
+    std::uint64_t bytes = 0;
+
+    friend AllocationStats operator-(const AllocationStats& x, const AllocationStats& y) noexcept
+    {
+        return {
+            .allocations = x.allocations - y.allocations,
+            .deallocations = x.deallocations - y.deallocations,
+            .bytes = x.bytes - y.bytes,
+        };
+    }
+};
+
+// Returns the allocations counted so far (of all the threads).
+AllocationStats allocation_stats() noexcept;
+
+// Counts the allocations since constructed, e.g.,
+//
+//     const AllocationCounter counter;
+//     const auto text = statement(invoice, plays);
+//     EXPECT_EQ(counter.stats().allocations, 1);
+//
+// including those of any other threads meanwhile.
+class AllocationCounter
+{
+public:
+    AllocationCounter() noexcept : start_{allocation_stats()} {}
+
+    AllocationStats stats() const noexcept { return allocation_stats() - start_; }
+
+private:
+    AllocationStats start_;
+};
@@ -0,0 +1,66 @@
+#include "pch.h"
+
+#include "alloc_check.h"
+
+#include <gtest/gtest.h>
+#include <gmock/gmock.h>
+
+using namespace testing;
+
+namespace {
+
+TEST(AllocCheckTest, Count)
+{
+    const AllocationCounter counter;
+    EXPECT_EQ(counter.stats().allocations, 0);
+
+    auto p = std::make_unique<std::int64_t>(42);
+    auto a = std::make_unique<char[]>(100);
+    auto stats = counter.stats();
+    EXPECT_EQ(stats.allocations, 2);
+    EXPECT_EQ(stats.deallocations, 0);
+    EXPECT_EQ(stats.bytes, sizeof(std::int64_t) + 100);
+
+    p.reset();
+    a.reset();
+    stats = counter.stats();
+    EXPECT_EQ(stats.allocations, 2);
+    EXPECT_EQ(stats.deallocations, 2);
+}
+
+TEST(AllocCheckTest, Aligned)
+{
+    struct alignas(256) Aligned
+    {
+        std::array<char, 8> bytes;
+    };
+
+    const AllocationCounter counter;
+    auto p = std::make_unique<Aligned>();
+    EXPECT_EQ(reinterpret_cast<std::uintptr_t>(p.get()) % 256, 0);
+    EXPECT_EQ(counter.stats().allocations, 1);
+    EXPECT_EQ(counter.stats().bytes, sizeof(Aligned));
+    p.reset();
+    EXPECT_EQ(counter.stats().deallocations, 1);
+}
+
+TEST(AllocCheckTest, Threads)
+{
+    const AllocationCounter counter;
+    std::thread{[] { std::vector<int> v(10); }}.join();
+    // including those of the other threads (e.g., of starting the thread itself)
+    EXPECT_GE(counter.stats().allocations, 1);
+    EXPECT_GE(counter.stats().bytes, 10 * sizeof(int));
+}
+
+TEST(AllocCheckTest, NoThrow)
+{
+    const AllocationCounter counter;
+    const auto p = new (std::nothrow) int{1};
+    ASSERT_NE(p, nullptr);
+    delete p;
+    EXPECT_EQ(counter.stats().allocations, 1);
+    EXPECT_EQ(counter.stats().deallocations, 1);
+}
+
+}
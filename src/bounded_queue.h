@@ -0,0 +1,61 @@
+#pragma once
+
+// Queue of up to `capacity` values passed from threads to threads,
+// which blocks producers while full (applying backpressure) and consumers while empty
+// until closed.
+template<typename T>
+class BoundedQueue
+{
+public:
+    // Throws `std::invalid_argument` if `capacity` is zero.
+    explicit BoundedQueue(std::size_t capacity) :
+        capacity_{capacity}
+    {
+        if (capacity == 0) { throw std::invalid_argument{"zero queue capacity"s}; }
+    }
+
+    // Appends `value` once there is room; returns false (dropping `value`) if closed.
+    bool push(T value)
+    {
+        std::unique_lock lock{mutex_};
+        not_full_.wait(lock, [this] { return closed_ || std::size(values_) < capacity_; });
+        if (closed_) { return false; }
+        values_.push_back(std::move(value));
+        lock.unlock();
+        not_empty_.notify_one();
+        return true;
+    }
+
+    // Takes the first value once there is any; returns `std::nullopt` if closed and drained.
+    std::optional<T> pop()
+    {
+        std::unique_lock lock{mutex_};
+        not_empty_.wait(lock, [this] { return closed_ || !values_.empty(); });
+        if (values_.empty()) { return std::nullopt; }
+        auto value = std::move(values_.front());
+        values_.pop_front();
+        lock.unlock();
+        not_full_.notify_one();
+        return value;
+    }
+
+    // Lets no more values in, waking up all the blocked threads;
+    // the values already in can still be taken.
+    void close()
+    {
+        {
+            const std::lock_guard lock{mutex_};
+            closed_ = true;
+        }
+        not_full_.notify_all();
+        not_empty_.notify_all();
+    }
+
+private:
+    std::mutex mutex_;
+    std::condition_variable not_full_;
+    std::condition_variable not_empty_;
+    std::deque<T> values_;
+    std::size_t capacity_;
+    bool closed_ = false;
+};
@@ -0,0 +1,51 @@
+#include "pch.h"
+
+#include "bounded_queue.h"
+
+#include <gtest/gtest.h>
+#include <gmock/gmock.h>
+
+using namespace testing;
+
+namespace {
+
+TEST(BoundedQueueTest, PushPop)
+{
+    BoundedQueue<std::string> queue{2};
+    EXPECT_TRUE(queue.push("a"s));
+    EXPECT_TRUE(queue.push("b"s));
+    EXPECT_EQ(queue.pop(), "a"s);
+
+    queue.close();
+    EXPECT_FALSE(queue.push("c"s));
+    EXPECT_EQ(queue.pop(), "b"s);
+    EXPECT_EQ(queue.pop(), std::nullopt);
+
+    EXPECT_THROW(BoundedQueue<int>{0}, std::invalid_argument);
+}
+
+TEST(BoundedQueueTest, Backpressure)
+{
+    constexpr int capacity = 4;
+    BoundedQueue<int> queue{capacity};
+    std::atomic<int> pushed = 0;
+
+    std::jthread producer{[&]
+    {
+        for (int i = 0; i < 100; ++i) {
+            if (!queue.push(i)) { break; }
+            ++pushed;
+        }
+        queue.close();
+    }};
+
+    // the producer gets blocked once the queue is full
+    while (pushed < capacity) { std::this_thread::yield(); }
+    std::this_thread::sleep_for(10ms);
+    EXPECT_EQ(pushed, capacity);
+
+    for (int i = 0; i < 100; ++i) { EXPECT_EQ(queue.pop(), i); }
+    EXPECT_EQ(queue.pop(), std::nullopt);
+}
+
+}
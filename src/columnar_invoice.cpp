@@ -0,0 +1,62 @@
+#include "pch.h"
+
+#include "columnar_invoice.h"
+
+#include "play_catalog.h"
+#include "pricing_rule.h"
+
+ColumnarInvoice make_columnar_invoice(const Invoice& invoice, const PlayCatalog& plays)
+{
+    const auto size = std::size(invoice.performances);
+    ColumnarInvoice columnar;
+    columnar.customer = invoice.customer;
+    columnar.play_handles.reserve(size);
+    columnar.play_types.reserve(size);
+    columnar.audiences.reserve(size);
+
+    for (const auto& perf : invoice.performances) {
+        const auto handle = plays.handle_for(perf);
+        columnar.play_handles.push_back(handle);
+        columnar.play_types.push_back(plays[handle].type);
+        columnar.audiences.push_back(perf.audience);
+    }
+    return columnar;
+}
+
+void price_performances(
+    std::span<const Play::Type> play_types, std::span<const int> audiences,
+    std::span<std::int64_t> amounts, std::span<std::int64_t> volume_credits)
+{
+    const auto size = std::size(play_types);
+    assert(std::size(audiences) == size);
+    assert(std::size(amounts) == size);
+    assert(std::size(volume_credits) == size);
+
+    // evaluate the rules for all the types and select the right ones
+    // (rather than switching on the type) to keep the loop free of branches
+    unsigned unknown_types = 0;
+    for (std::size_t i = 0; i < size; ++i) {
+        const auto type = play_types[i];
+        const auto audience = audiences[i];
+        unknown_types |= !KnownPlayTypes::contains(type);
+
+        std::int64_t amount = 0;
+        std::int64_t credits = 0;
+        KnownPlayTypes::for_each([&](auto t)
+        {
+            using Rule = PricingRule<decltype(t)::value>;
+            const bool selected = decltype(t)::value == type;
+            amount = selected ? Rule::amount(audience) : amount;
+            credits = selected ? Rule::volume_credits(audience) : credits;
+        });
+        amounts[i] = amount;
+        volume_credits[i] = credits;
+    }
+
+    if (unknown_types) {
+        throw_unknown_type(*std::ranges::find_if(play_types, [](auto type)
+        {
+            return !KnownPlayTypes::contains(type);
+        }));
+    }
+}
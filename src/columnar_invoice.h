@@ -0,0 +1,28 @@
+#pragma once
+
+#include "statement.h"
+
+// Invoice laid out column by column ("structure of arrays"),
+// where the i-th performance is described by the i-th element of each column
+struct ColumnarInvoice
+{
+    std::string customer;
+    std::vector<PlayHandle> play_handles;
+    std::vector<Play::Type> play_types;
+    std::vector<int> audiences;
+
+    std::size_t size() const noexcept { return std::size(audiences); }
+};
+
+// Lays out `invoice` column by column, resolving its plays in `plays`;
+// throws `std::out_of_range` if any play is not cataloged.
+ColumnarInvoice make_columnar_invoice(const Invoice& invoice, const PlayCatalog& plays);
+
+// Calculates the amounts and the volume credits for the performances given column by column,
+// which is the same as `enrich_performance` does for each performance but without branching
+// so that compilers can vectorize the loop over thousands of performances;
+// throws `std::runtime_error` (leaving the outputs unspecified) for an unknown `Play::Type`.
+// All the spans shall be of the same size.
+void price_performances(
+    std::span<const Play::Type> play_types, std::span<const int> audiences,
+    std::span<std::int64_t> amounts, std::span<std::int64_t> volume_credits);
@@ -0,0 +1,82 @@
+#include "pch.h"
+
+#include "columnar_invoice.h"
+
+#include "make_statement_data.h"
+#include "play_catalog.h"
+
+#include <gtest/gtest.h>
+#include <gmock/gmock.h>
+
+using namespace testing;
+
+namespace {
+
+TEST(ColumnarInvoiceTest, MakeColumnarInvoice)
+{
+    const PlayCatalog plays{{
+        {"hamlet"s, {.name = "Hamlet"s, .type = Play::Type::Tragedy}},
+        {"as-like"s, {.name = "As You Like It"s, .type = Play::Type::Comedy}},
+    }};
+
+    const Invoice invoice{
+        .customer = "BigCo"s,
+        .performances = {
+            {
+                .play_id = "hamlet"s,
+                .audience = 55
+            },
+            {
+                .play_id = "as-like"s,
+                .audience = 35
+            },
+        }
+    };
+
+    const auto columnar = make_columnar_invoice(invoice, plays);
+
+    EXPECT_EQ(columnar.customer, "BigCo"s);
+    EXPECT_EQ(columnar.size(), 2);
+    EXPECT_THAT(columnar.play_handles, ElementsAre(*plays.find("hamlet"sv), *plays.find("as-like"sv)));
+    EXPECT_THAT(columnar.play_types, ElementsAre(Play::Type::Tragedy, Play::Type::Comedy));
+    EXPECT_THAT(columnar.audiences, ElementsAre(55, 35));
+}
+
+TEST(ColumnarInvoiceTest, PricePerformances)
+{
+    std::vector<Play::Type> play_types;
+    std::vector<int> audiences;
+    for (int audience = 0; audience <= 1000; ++audience) {
+        for (const auto type : {Play::Type::Tragedy, Play::Type::Comedy}) {
+            play_types.push_back(type);
+            audiences.push_back(audience);
+        }
+    }
+
+    std::vector<std::int64_t> amounts(std::size(audiences));
+    std::vector<std::int64_t> volume_credits(std::size(audiences));
+    price_performances(play_types, audiences, amounts, volume_credits);
+
+    for (std::size_t i = 0; i < std::size(audiences); ++i) {
+        const Play play{.name = "XYZ"s, .type = play_types[i]};
+        const Performance perf{.play_id = "xyz"s, .audience = audiences[i]};
+        const auto expected = enrich_performance(perf, play);
+        EXPECT_EQ(amounts[i], expected.amount) << i;
+        EXPECT_EQ(volume_credits[i], expected.volume_credits) << i;
+    }
+}
+
+TEST(ColumnarInvoiceTest, UnknownType)
+{
+    const std::vector play_types{Play::Type::Tragedy, static_cast<Play::Type>(-1), static_cast<Play::Type>(2)};
+    const std::vector audiences{10, 20, 30};
+
+    std::vector<std::int64_t> amounts(std::size(audiences));
+    std::vector<std::int64_t> volume_credits(std::size(audiences));
+
+    EXPECT_THAT(
+        [&] { price_performances(play_types, audiences, amounts, volume_credits); },
+        ThrowsMessage<std::runtime_error>(Eq("-1: unknown Play::Type"s)));
+}
+
+}
@@ -0,0 +1,51 @@
+#pragma once
+
+// 64-bit FNV-1a hash fed with values one by one, e.g.,
+//
+//     const auto digest = ContentHash{}.add(invoice.customer).add(perf.audience).digest();
+//
+// which, unlike `std::hash`, is the same from run to run and from platform to platform
+// (adding integers byte by byte from the least significant) so that it can key what outlives the process.
+// Strings are prefixed by their sizes so that adjacent ones cannot run into each other.
+class ContentHash
+{
+public:
+    constexpr ContentHash() noexcept = default;
+    // Continues from `digest` of the values added to another hash.
+    constexpr explicit ContentHash(std::uint64_t digest) noexcept : state_{digest} {}
+
+    constexpr ContentHash& add(std::string_view s) noexcept
+    {
+        add(static_cast<std::uint64_t>(std::size(s)));
+        for (const auto c : s) { add_byte(static_cast<unsigned char>(c)); }
+        return *this;
+    }
+
+    template<std::integral T>
+    constexpr ContentHash& add(T value) noexcept
+    {
+        auto bits = static_cast<std::make_unsigned_t<T>>(value);
+        for (std::size_t i = 0; i < sizeof(T); ++i) {
+            add_byte(static_cast<unsigned char>(bits & 0xFF));
+            bits = static_cast<decltype(bits)>(bits >> 8);
+        }
+        return *this;
+    }
+
+    template<typename E>
+        requires std::is_enum_v<E>
+    constexpr ContentHash& add(E value) noexcept
+    {
+        return add(static_cast<std::underlying_type_t<E>>(value));
+    }
+
+    constexpr std::uint64_t digest() const noexcept { return state_; }
+
+private:
+    constexpr void add_byte(unsigned char byte) noexcept
+    {
+        state_ = (state_ ^ byte) * 0x100000001B3ull;
+    }
+
+    std::uint64_t state_ = 0xCBF29CE484222325ull;
+};
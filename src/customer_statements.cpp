@@ -0,0 +1,136 @@
+#include "pch.h"
+
+#include "customer_statements.h"
+
+#include "play_catalog.h"
+#include "render_statement.h"
+
+namespace {
+
+// Returns the indices of the invoices for each customer in the order of their first invoices.
+std::vector<std::vector<std::size_t>> group_by_customer(std::span<const Invoice> invoices)
+{
+    std::unordered_map<std::string_view, std::size_t, StringHash, std::equal_to<>> group_indices;
+    std::vector<std::vector<std::size_t>> groups;
+    for (std::size_t i = 0; i < std::size(invoices); ++i) {
+        const auto [it, added] = group_indices.try_emplace(invoices[i].customer, std::size(groups));
+        if (added) { groups.emplace_back(); }
+        groups[it->second].push_back(i);
+    }
+    return groups;
+}
+
+// Invoice with all the `performances` (e.g., joined from several invoices) of `customer`
+// to render with `render_statement`
+template<typename Performances>
+struct CustomerInvoice
+{
+    std::string_view customer;
+    Performances performances;
+};
+
+template<typename Plays>
+CustomerStatement render_customer_statement(
+    std::span<const Invoice> invoices, std::span<const std::size_t> group, const Plays& plays)
+{
+    CustomerStatement result{
+        .customer = invoices[group.front()].customer,
+        .text = {},
+        .total_amount = Money{},
+        .volume_credits = 0
+    };
+
+    std::size_t size = 0;
+    for (const auto i : group) { size += estimated_statement_size(invoices[i]); }
+    result.text.reserve(size);
+
+    const CustomerInvoice invoice{
+        .customer = result.customer,
+        .performances = group | std::views::transform([invoices](std::size_t i) -> const auto&
+        {
+            return invoices[i].performances;
+        }) | std::views::join,
+    };
+    StatementTotals totals;
+    render_statement(std::back_inserter(result.text), invoice, plays, totals);
+    result.total_amount = totals.amount;
+    result.volume_credits = totals.volume_credits;
+    return result;
+}
+
+template<typename Plays>
+std::vector<CustomerStatement> render_customer_statements(
+    std::span<const Invoice> invoices, const Plays& plays)
+{
+    const auto groups = group_by_customer(invoices);
+    std::vector<CustomerStatement> results;
+    results.reserve(std::size(groups));
+    for (const auto& group : groups) { results.push_back(render_customer_statement(invoices, group, plays)); }
+    return results;
+}
+
+template<typename Plays>
+std::vector<CustomerStatement> render_customer_statements_in_parallel(
+    std::span<const Invoice> invoices, const Plays& plays)
+{
+    const auto groups = group_by_customer(invoices);
+    const auto num_workers = static_cast<std::size_t>(std::max(std::thread::hardware_concurrency(), 1u));
+    const auto num_threads = std::min(num_workers, std::size(groups));
+
+    std::vector<CustomerStatement> results(std::size(groups));
+    std::vector<std::exception_ptr> errors(std::size(groups));
+    std::atomic<std::size_t> next_group = 0;
+
+    auto render_groups = [&]
+    {
+        for (auto i = next_group++; i < std::size(groups); i = next_group++) {
+            try {
+                results[i] = render_customer_statement(invoices, groups[i], plays);
+            }
+            catch (...) {
+                errors[i] = std::current_exception();
+            }
+        }
+    };
+
+    {
+        std::vector<std::jthread> workers;
+        workers.reserve(num_threads > 0 ? num_threads - 1 : 0);
+        for (std::size_t i = 1; i < num_threads; ++i) { workers.emplace_back(render_groups); }
+        render_groups();
+    }
+
+    // report the error that the sequential rendering would have encountered first
+    for (const auto& error : errors) {
+        if (error) { std::rethrow_exception(error); }
+    }
+    return results;
+}
+
+}
+
+std::vector<CustomerStatement> customer_statements(
+    std::span<const Invoice> invoices, const std::map<std::string, Play>& plays)
+{
+    return render_customer_statements(invoices, plays);
+}
+
+std::vector<CustomerStatement> customer_statements(
+    std::span<const Invoice> invoices, const PlayCatalog& plays)
+{
+    return render_customer_statements(invoices, plays);
+}
+
+std::vector<CustomerStatement> customer_statements(
+    const std::execution::parallel_policy&,
+    std::span<const Invoice> invoices, const std::map<std::string, Play>& plays)
+{
+    return render_customer_statements_in_parallel(invoices, plays);
+}
+
+std::vector<CustomerStatement> customer_statements(
+    const std::execution::parallel_policy&,
+    std::span<const Invoice> invoices, const PlayCatalog& plays)
+{
+    return render_customer_statements_in_parallel(invoices, plays);
+}
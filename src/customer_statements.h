@@ -0,0 +1,33 @@
+#pragma once
+
+#include "money.h"
+#include "statement.h"
+
+// Consolidated statement for all the invoices of a customer
+struct CustomerStatement
+{
+    // refers to the customer of the invoices, which must outlive this
+    std::string_view customer;
+    // the same as `statement` for an invoice with all the performances of the invoices in order
+    std::string text;
+    Money total_amount;
+    std::int64_t volume_credits;
+};
+
+// Groups `invoices` by customer and renders the consolidated statement for each customer
+// in the order of their first invoices, right from the performances of the invoices
+// (without copying them into an invoice per customer);
+// throws the exception for the earliest failed customer as `statement` would.
+std::vector<CustomerStatement> customer_statements(
+    std::span<const Invoice> invoices, const std::map<std::string, Play>& plays);
+std::vector<CustomerStatement> customer_statements(
+    std::span<const Invoice> invoices, const PlayCatalog& plays);
+
+// Do the same as `customer_statements` but render the customers in parallel
+// on all the hardware threads.
+std::vector<CustomerStatement> customer_statements(
+    const std::execution::parallel_policy& policy,
+    std::span<const Invoice> invoices, const std::map<std::string, Play>& plays);
+std::vector<CustomerStatement> customer_statements(
+    const std::execution::parallel_policy& policy,
+    std::span<const Invoice> invoices, const PlayCatalog& plays);
@@ -0,0 +1,106 @@
+#include "pch.h"
+
+#include "customer_statements.h"
+
+#include "play_catalog.h"
+
+#include <gtest/gtest.h>
+#include <gmock/gmock.h>
+
+using namespace testing;
+
+namespace {
+
+const std::map<std::string, Play> plays{
+    {"hamlet"s, {.name = "Hamlet"s, .type = Play::Type::Tragedy}},
+    {"as-like"s, {.name = "As You Like It"s, .type = Play::Type::Comedy}},
+    {"othello"s, {.name = "Othello"s, .type = Play::Type::Tragedy}},
+};
+
+TEST(CustomerStatementsTest, BigCo)
+{
+    const std::vector<Invoice> invoices{
+        {
+            .customer = "BigCo"s,
+            .performances = {
+                {.play_id = "hamlet"s, .audience = 55},
+                {.play_id = "as-like"s, .audience = 35},
+            }
+        },
+        {
+            .customer = "SmallCo"s,
+            .performances = {{.play_id = "as-like"s, .audience = 10}}
+        },
+        {
+            .customer = "BigCo"s,
+            .performances = {{.play_id = "othello"s, .audience = 40}}
+        },
+    };
+
+    const auto results = customer_statements(invoices, plays);
+    ASSERT_EQ(std::size(results), 2);
+
+    EXPECT_EQ(results[0].customer, "BigCo"sv);
+    EXPECT_EQ(results[0].text, R"###(Statement for BigCo
+  Hamlet: $650.00 (55 seats)
+  As You Like It: $580.00 (35 seats)
+  Othello: $500.00 (40 seats)
+Amount owed is $1,730.00
+You earned 47 credits
+)###"s);
+    EXPECT_EQ(results[0].total_amount, Money{173000});
+    EXPECT_EQ(results[0].volume_credits, 47);
+
+    EXPECT_EQ(results[1].customer, "SmallCo"sv);
+    EXPECT_EQ(results[1].text, statement(invoices[1], plays));
+    EXPECT_EQ(results[1].total_amount, Money{33000});
+    EXPECT_EQ(results[1].volume_credits, 2);
+
+    EXPECT_THAT(customer_statements({}, plays), IsEmpty());
+}
+
+TEST(CustomerStatementsTest, Parallel)
+{
+    const PlayCatalog catalog{plays};
+    const std::array play_ids{"hamlet"s, "as-like"s, "othello"s};
+
+    std::vector<Invoice> invoices(1000);
+    for (int i = 0; auto& invoice : invoices) {
+        invoice.customer = std::format("Customer #{}"sv, i % 37);
+        for (int j = 0; j < i % 5; ++j) {
+            invoice.performances.push_back({.play_id = play_ids[(i + j) % 3], .audience = i * j % 100});
+        }
+        ++i;
+    }
+
+    const auto expected = customer_statements(invoices, plays);
+    ASSERT_EQ(std::size(expected), 37);
+    for (std::size_t k = 0; k < std::size(expected); ++k) {
+        // the same as the statement for the performances concatenated
+        Invoice concatenated{.customer = std::format("Customer #{}"sv, k), .performances = {}};
+        for (std::size_t i = k; i < std::size(invoices); i += 37) {
+            std::ranges::copy(invoices[i].performances, std::back_inserter(concatenated.performances));
+        }
+        EXPECT_EQ(expected[k].text, statement(concatenated, plays)) << k;
+    }
+
+    for (const auto& actual : {
+        customer_statements(invoices, catalog),
+        customer_statements(std::execution::par, invoices, plays),
+        customer_statements(std::execution::par, invoices, catalog)}) {
+        ASSERT_EQ(std::size(actual), std::size(expected));
+        for (std::size_t k = 0; k < std::size(expected); ++k) {
+            EXPECT_EQ(actual[k].customer, expected[k].customer);
+            EXPECT_EQ(actual[k].text, expected[k].text);
+            EXPECT_EQ(actual[k].total_amount, expected[k].total_amount);
+            EXPECT_EQ(actual[k].volume_credits, expected[k].volume_credits);
+        }
+    }
+
+    invoices[500].performances.push_back({.play_id = "macbeth"s, .audience = 1});
+    EXPECT_THAT(
+        [&] { customer_statements(std::execution::par, invoices, catalog); },
+        ThrowsMessage<std::out_of_range>(Eq("macbeth: unknown play ID"s)));
+}
+
+}
@@ -0,0 +1,68 @@
+#include "pch.h"
+
+#include "fd_streambuf.h"
+
+#if defined(_WIN32)
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
+
+FdStreamBuf::FdStreamBuf(int fd) :
+    fd_{fd}
+{
+    setp(std::data(buffer_), std::data(buffer_) + std::size(buffer_));
+}
+
+FdStreamBuf::~FdStreamBuf()
+{
+    flush();
+}
+
+FdStreamBuf::int_type FdStreamBuf::overflow(int_type ch)
+{
+    if (!flush()) { return traits_type::eof(); }
+    if (traits_type::eq_int_type(ch, traits_type::eof())) { return traits_type::not_eof(ch); }
+    *pptr() = traits_type::to_char_type(ch);
+    pbump(1);
+    return ch;
+}
+
+std::streamsize FdStreamBuf::xsputn(const char_type* s, std::streamsize count)
+{
+    // write a chunk at least as large as the buffer directly (rather than copying it);
+    // copy anything smaller, flushing the buffer as it fills (by `overflow`)
+    if (count < std::ssize(buffer_)) { return std::streambuf::xsputn(s, count); }
+    if (!flush() || !write_all(s, static_cast<std::size_t>(count))) { return 0; }
+    return count;
+}
+
+int FdStreamBuf::sync()
+{
+    return flush() ? 0 : -1;
+}
+
+bool FdStreamBuf::write_all(const char* data, std::size_t size) noexcept
+{
+    while (size > 0) {
+#if defined(_WIN32)
+        const auto written = ::_write(fd_, data, static_cast<unsigned>(std::min<std::size_t>(size, INT_MAX)));
+#else
+        const auto written = ::write(fd_, data, size);
+#endif
+        if (written < 0) {
+            if (errno == EINTR) { continue; }
+            return false;
+        }
+        data += written;
+        size -= static_cast<std::size_t>(written);
+    }
+    return true;
+}
+
+bool FdStreamBuf::flush() noexcept
+{
+    const auto size = static_cast<std::size_t>(pptr() - pbase());
+    setp(std::data(buffer_), std::data(buffer_) + std::size(buffer_));
+    return write_all(std::data(buffer_), size);
+}
@@ -0,0 +1,31 @@
+#pragma once
+
+// Output stream buffer writing to a file descriptor (e.g., of a file, pipe, or socket)
+// through a fixed-size buffer, which is to be used as:
+//
+//     FdStreamBuf buf{fd};
+//     std::ostream os{&buf};
+//     statements(invoices, plays, os);
+//
+// The file descriptor is not owned (i.e., not closed on destruction).
+class FdStreamBuf final : public std::streambuf
+{
+public:
+    explicit FdStreamBuf(int fd);
+    FdStreamBuf(const FdStreamBuf&) = delete;
+    FdStreamBuf& operator=(const FdStreamBuf&) = delete;
+    // Flushes the buffer, ignoring errors (`sync` explicitly to detect them).
+    ~FdStreamBuf() override;
+
+protected:
+    int_type overflow(int_type ch) override;
+    std::streamsize xsputn(const char_type* s, std::streamsize count) override;
+    int sync() override;
+
+private:
+    bool write_all(const char* data, std::size_t size) noexcept;
+    bool flush() noexcept;
+
+    int fd_;
+    std::array<char, 64 * 1024> buffer_;
+};
@@ -0,0 +1,82 @@
+#include "pch.h"
+
+#include "fd_streambuf.h"
+
+#include <gtest/gtest.h>
+#include <gmock/gmock.h>
+
+#if defined(_WIN32)
+#include <io.h>
+#define fileno _fileno
+#define lseek _lseek
+#else
+#include <unistd.h>
+#endif
+
+using namespace testing;
+
+namespace {
+
+std::string read_all(std::FILE* file)
+{
+    std::rewind(file);
+    std::string str;
+    std::array<char, 4096> buffer;
+    while (const auto size = std::fread(std::data(buffer), 1, std::size(buffer), file)) {
+        str.append(std::data(buffer), size);
+    }
+    return str;
+}
+
+TEST(FdStreamBufTest, Write)
+{
+    const std::unique_ptr<std::FILE, decltype(&std::fclose)> file{std::tmpfile(), &std::fclose};
+    ASSERT_TRUE(file);
+
+    const auto long_line = std::string(100'000, 'x') + '\n';
+    std::string expected_text;
+    {
+        FdStreamBuf buf{fileno(file.get())};
+        std::ostream os{&buf};
+        for (int i = 0; i < 10'000; ++i) {
+            os << "line #" << i << '\n';
+            expected_text += std::format("line #{}\n"sv, i);
+        }
+        os << long_line;
+        expected_text += long_line;
+        os << std::flush;
+        ASSERT_TRUE(os);
+        os << "unflushed\n"sv;
+        expected_text += "unflushed\n"sv;
+    }
+
+    EXPECT_EQ(read_all(file.get()), expected_text);
+}
+
+TEST(FdStreamBufTest, Buffered)
+{
+    const std::unique_ptr<std::FILE, decltype(&std::fclose)> file{std::tmpfile(), &std::fclose};
+    ASSERT_TRUE(file);
+    const auto fd = fileno(file.get());
+
+    // chunks smaller than the buffer fill it up before it is written at once
+    const std::string chunk(1'000, 'x');
+    FdStreamBuf buf{fd};
+    std::ostream os{&buf};
+    for (int i = 0; i < 70; ++i) { os << chunk; }
+    ASSERT_TRUE(os);
+    EXPECT_EQ(lseek(fd, 0, SEEK_CUR), 64 * 1024);
+
+    os << std::flush;
+    EXPECT_EQ(lseek(fd, 0, SEEK_CUR), 70'000);
+}
+
+TEST(FdStreamBufTest, BadFd)
+{
+    FdStreamBuf buf{-1};
+    std::ostream os{&buf};
+    os << "some text" << std::flush;
+    EXPECT_TRUE(os.bad());
+}
+
+}
@@ -0,0 +1,66 @@
+#pragma once
+
+// Coroutine yielding values of `T` one by one on demand (cf. C++23 `std::generator`), e.g.,
+//
+//     Generator<Invoice> parse(std::istream& is)
+//     {
+//         while (...) { co_yield invoice; }
+//     }
+//
+// so that a producer can be written as a plain loop and yet be run lazily by its consumer.
+template<typename T>
+class Generator
+{
+public:
+    struct promise_type
+    {
+        std::optional<T> value;
+        std::exception_ptr error;
+
+        Generator get_return_object() noexcept
+        {
+            return Generator{std::coroutine_handle<promise_type>::from_promise(*this)};
+        }
+        std::suspend_always initial_suspend() noexcept { return {}; }
+        std::suspend_always final_suspend() noexcept { return {}; }
+
+        std::suspend_always yield_value(T yielded)
+        {
+            value = std::move(yielded);
+            return {};
+        }
+        void return_void() noexcept {}
+        void unhandled_exception() noexcept { error = std::current_exception(); }
+    };
+
+    Generator(Generator&& other) noexcept : handle_{std::exchange(other.handle_, nullptr)} {}
+    Generator& operator=(Generator&& other) noexcept
+    {
+        if (this != &other) {
+            if (handle_) { handle_.destroy(); }
+            handle_ = std::exchange(other.handle_, nullptr);
+        }
+        return *this;
+    }
+    ~Generator()
+    {
+        if (handle_) { handle_.destroy(); }
+    }
+
+    // Resumes the coroutine until it yields the next value, which is returned,
+    // or finishes, returning `std::nullopt`; rethrows what the coroutine throws.
+    std::optional<T> next()
+    {
+        if (!handle_ || handle_.done()) { return std::nullopt; }
+        auto& promise = handle_.promise();
+        promise.value.reset();
+        handle_.resume();
+        if (promise.error) { std::rethrow_exception(std::exchange(promise.error, nullptr)); }
+        return std::exchange(promise.value, std::nullopt);
+    }
+
+private:
+    explicit Generator(std::coroutine_handle<promise_type> handle) noexcept : handle_{handle} {}
+
+    std::coroutine_handle<promise_type> handle_;
+};
@@ -0,0 +1,110 @@
+#include "pch.h"
+
+#include "genre_registry.h"
+
+#include "make_statement_data.h"
+#include "pricing_rule.h"
+#include "statement_renderers.h"
+
+namespace {
+
+constexpr auto unregistered = std::numeric_limits<std::size_t>::max();
+
+template<Play::Type type>
+void price_batch(
+    std::span<const int> audiences, std::span<std::int64_t> amounts, std::span<std::int64_t> volume_credits)
+{
+    using Rule = PricingRule<type>;
+    for (std::size_t i = 0; i < std::size(audiences); ++i) {
+        amounts[i] = Rule::amount(audiences[i]);
+        volume_credits[i] = Rule::volume_credits(audiences[i]);
+    }
+}
+
+}
+
+GenreRegistry::GenreRegistry()
+{
+    KnownPlayTypes::for_each([this](auto t)
+    {
+        add(decltype(t)::value, price_batch<decltype(t)::value>);
+    });
+}
+
+bool GenreRegistry::add(Play::Type type, BatchPricing pricing)
+{
+    const auto raw_type = static_cast<std::underlying_type_t<Play::Type>>(type);
+    if (raw_type < 0) { throw std::invalid_argument{std::format("{}: negative Play::Type"sv, raw_type)}; }
+    if (type > max_type) { throw std::invalid_argument{std::format("{}: too large Play::Type"sv, raw_type)}; }
+    if (!pricing) { throw std::invalid_argument{std::format("{}: no pricing for Play::Type"sv, raw_type)}; }
+    if (contains(type)) { return false; }
+
+    const auto value = static_cast<std::size_t>(type);
+    if (value >= std::size(indices_)) { indices_.resize(value + 1, unregistered); }
+    pricings_.push_back(std::move(pricing));
+    indices_[value] = std::size(pricings_) - 1;
+    return true;
+}
+
+void GenreRegistry::price_performances(
+    std::span<const Play::Type> play_types, std::span<const int> audiences,
+    std::span<std::int64_t> amounts, std::span<std::int64_t> volume_credits) const
+{
+    const auto size = std::size(play_types);
+    assert(std::size(audiences) == size);
+    assert(std::size(amounts) == size);
+    assert(std::size(volume_credits) == size);
+
+    // count the performances of each genre (into the next slot for the prefix sum below)
+    std::vector<std::size_t> offsets(std::size(pricings_) + 1);
+    for (const auto type : play_types) {
+        const auto index = index_of(type);
+        if (index >= std::size(pricings_)) { throw_unknown_type(type); }
+        ++offsets[index + 1];
+    }
+    std::partial_sum(std::cbegin(offsets), std::cend(offsets), std::begin(offsets));
+
+    // gather the audiences genre by genre, remembering where each came from
+    std::vector<std::size_t> order(size);
+    std::vector<int> grouped_audiences(size);
+    {
+        auto next = offsets;
+        for (std::size_t i = 0; i < size; ++i) {
+            const auto k = next[index_of(play_types[i])]++;
+            order[k] = i;
+            grouped_audiences[k] = audiences[i];
+        }
+    }
+
+    std::vector<std::int64_t> grouped_amounts(size);
+    std::vector<std::int64_t> grouped_volume_credits(size);
+    for (std::size_t index = 0; index < std::size(pricings_); ++index) {
+        const auto first = offsets[index];
+        const auto count = offsets[index + 1] - first;
+        if (count == 0) { continue; }
+        pricings_[index](
+            std::span{grouped_audiences}.subspan(first, count),
+            std::span{grouped_amounts}.subspan(first, count),
+            std::span{grouped_volume_credits}.subspan(first, count));
+    }
+
+    // scatter the results back in the original order
+    for (std::size_t k = 0; k < size; ++k) {
+        amounts[order[k]] = grouped_amounts[k];
+        volume_credits[order[k]] = grouped_volume_credits[k];
+    }
+}
+
+std::string statement(const Invoice& invoice, const std::map<std::string, Play>& plays, const GenreRegistry& genres)
+{
+    std::string out;
+    render_text(make_statement_data(invoice, plays, genres), out);
+    return out;
+}
+
+std::string statement(const Invoice& invoice, const PlayCatalog& plays, const GenreRegistry& genres)
+{
+    std::string out;
+    render_text(make_statement_data(invoice, plays, genres), out);
+    return out;
+}
@@ -0,0 +1,57 @@
+#pragma once
+
+#include "statement.h"
+
+// Calculates the amounts and the volume credits for the performances of plays of a genre
+// given their audiences; all the spans are of the same size.
+using BatchPricing = std::function<void(
+    std::span<const int> audiences, std::span<std::int64_t> amounts,
+    std::span<std::int64_t> volume_credits)>;
+
+// Registry of genres, each of which is identified by a (non-negative) `Play::Type` value
+// beyond the known ones and prices its performances in batches
+// so that the cost of the dispatch is paid per genre rather than per performance
+// (unlike a virtual call per performance).
+// The known types (see `KnownPlayTypes`) are registered on construction.
+// (See `make_statement_data` and `statement` with `GenreRegistry` for rendering with it.)
+class GenreRegistry
+{
+public:
+    GenreRegistry();
+
+    // `Play::Type` values are dense by design, indexing a table up to the largest registered
+    static constexpr auto max_type = Play::Type{1023};
+
+    // Registers the genre of `type` priced by `pricing` unless `type` is already registered;
+    // returns whether registered. Throws `std::invalid_argument` if `type` is negative
+    // or beyond `max_type`, or if `pricing` is empty.
+    bool add(Play::Type type, BatchPricing pricing);
+
+    bool contains(Play::Type type) const noexcept { return index_of(type) < std::size(pricings_); }
+
+    // Calculates the amounts and the volume credits for the performances given column by column,
+    // grouping them by genre so as to call the pricing of each genre only once;
+    // throws `std::runtime_error` (leaving the outputs intact) for an unregistered `Play::Type`.
+    // All the spans shall be of the same size.
+    void price_performances(
+        std::span<const Play::Type> play_types, std::span<const int> audiences,
+        std::span<std::int64_t> amounts, std::span<std::int64_t> volume_credits) const;
+
+private:
+    // Returns the index of `type` into `pricings_`, which is out of range if unregistered.
+    std::size_t index_of(Play::Type type) const noexcept
+    {
+        const auto value = static_cast<std::size_t>(type);
+        return value < std::size(indices_) ? indices_[value] : std::size(pricings_);
+    }
+
+    std::vector<BatchPricing> pricings_;
+    // indexed by `Play::Type` values (no more than `max_type + 1` of them)
+    std::vector<std::size_t> indices_;
+};
+
+// Returns the same as `statement` but prices the performances with `genres`
+// (see `make_statement_data` with `GenreRegistry`), i.e., accepting the plays of any genre
+// registered; throws `std::runtime_error` for a `Play::Type` not registered.
+std::string statement(const Invoice& invoice, const std::map<std::string, Play>& plays, const GenreRegistry& genres);
+std::string statement(const Invoice& invoice, const PlayCatalog& plays, const GenreRegistry& genres);
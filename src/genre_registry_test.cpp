@@ -0,0 +1,138 @@
+#include "pch.h"
+
+#include "genre_registry.h"
+
+#include "columnar_invoice.h"
+#include "play_catalog.h"
+
+#include <gtest/gtest.h>
+#include <gmock/gmock.h>
+
+using namespace testing;
+
+namespace {
+
+constexpr auto musical = static_cast<Play::Type>(2);
+
+TEST(GenreRegistryTest, KnownTypes)
+{
+    const GenreRegistry genres;
+
+    std::vector<Play::Type> play_types;
+    std::vector<int> audiences;
+    for (int audience = 0; audience <= 1000; ++audience) {
+        for (const auto type : {Play::Type::Comedy, Play::Type::Tragedy, Play::Type::Comedy}) {
+            play_types.push_back(type);
+            audiences.push_back(audience);
+        }
+    }
+
+    std::vector<std::int64_t> expected_amounts(std::size(audiences));
+    std::vector<std::int64_t> expected_volume_credits(std::size(audiences));
+    price_performances(play_types, audiences, expected_amounts, expected_volume_credits);
+
+    std::vector<std::int64_t> amounts(std::size(audiences));
+    std::vector<std::int64_t> volume_credits(std::size(audiences));
+    genres.price_performances(play_types, audiences, amounts, volume_credits);
+
+    EXPECT_EQ(amounts, expected_amounts);
+    EXPECT_EQ(volume_credits, expected_volume_credits);
+}
+
+TEST(GenreRegistryTest, Add)
+{
+    GenreRegistry genres;
+    EXPECT_TRUE(genres.contains(Play::Type::Tragedy));
+    EXPECT_FALSE(genres.contains(musical));
+
+    int calls = 0;
+    EXPECT_TRUE(genres.add(musical, [&](auto audiences, auto amounts, auto volume_credits)
+    {
+        ++calls;
+        std::ranges::transform(audiences, std::begin(amounts), [](int audience) { return 100 * audience; });
+        std::ranges::fill(volume_credits, 1);
+    }));
+    EXPECT_FALSE(genres.add(musical, [](auto, auto, auto) {}));
+    EXPECT_TRUE(genres.contains(musical));
+
+    const BatchPricing no_pricing = [](auto, auto, auto) {};
+    EXPECT_THROW(genres.add(static_cast<Play::Type>(-1), no_pricing), std::invalid_argument);
+    EXPECT_THROW(genres.add(static_cast<Play::Type>(INT_MAX), no_pricing), std::invalid_argument);
+    EXPECT_THROW(genres.add(static_cast<Play::Type>(3), nullptr), std::invalid_argument);
+    EXPECT_FALSE(genres.contains(static_cast<Play::Type>(3)));
+    EXPECT_TRUE(genres.add(GenreRegistry::max_type, no_pricing));
+
+    const std::vector play_types{musical, Play::Type::Tragedy, musical, Play::Type::Comedy, musical};
+    const std::vector audiences{1, 55, 2, 35, 3};
+    std::vector<std::int64_t> amounts(std::size(audiences));
+    std::vector<std::int64_t> volume_credits(std::size(audiences));
+    genres.price_performances(play_types, audiences, amounts, volume_credits);
+
+    EXPECT_EQ(calls, 1);
+    EXPECT_THAT(amounts, ElementsAre(100, 65000, 200, 58000, 300));
+    EXPECT_THAT(volume_credits, ElementsAre(1, 25, 1, 12, 1));
+}
+
+TEST(GenreRegistryTest, UnknownType)
+{
+    const GenreRegistry genres;
+
+    const std::vector play_types{Play::Type::Tragedy, musical, static_cast<Play::Type>(-1)};
+    const std::vector audiences{10, 20, 30};
+    std::vector<std::int64_t> amounts(std::size(audiences));
+    std::vector<std::int64_t> volume_credits(std::size(audiences));
+
+    EXPECT_THAT(
+        [&] { genres.price_performances(play_types, audiences, amounts, volume_credits); },
+        ThrowsMessage<std::runtime_error>(Eq("2: unknown Play::Type"s)));
+    EXPECT_THAT(amounts, Each(0));
+}
+
+TEST(GenreRegistryTest, Statement)
+{
+    GenreRegistry genres;
+    int calls = 0;
+    genres.add(musical, [&](auto audiences, auto amounts, auto volume_credits)
+    {
+        ++calls;
+        std::ranges::transform(audiences, std::begin(amounts), [](int audience) { return 100 * audience; });
+        std::ranges::fill(volume_credits, 1);
+    });
+
+    const std::map<std::string, Play> plays{
+        {"hamlet"s, {.name = "Hamlet"s, .type = Play::Type::Tragedy}},
+        {"cats"s, {.name = "Cats"s, .type = musical}},
+        {"evita"s, {.name = "Evita"s, .type = musical}},
+    };
+    const PlayCatalog catalog{plays};
+    const Invoice invoice{
+        .customer = "BigCo"s,
+        .performances = {
+            {.play_id = "cats"s, .audience = 10},
+            {.play_id = "hamlet"s, .audience = 55},
+            {.play_id = "evita"s, .audience = 20},
+        }
+    };
+
+    const auto expected_text = R"###(Statement for BigCo
+  Cats: $10.00 (10 seats)
+  Hamlet: $650.00 (55 seats)
+  Evita: $20.00 (20 seats)
+Amount owed is $680.00
+You earned 27 credits
+)###"s;
+    EXPECT_EQ(statement(invoice, plays, genres), expected_text);
+    EXPECT_EQ(statement(invoice, catalog, genres), expected_text);
+    // each genre priced once per invoice
+    EXPECT_EQ(calls, 2);
+
+    // the same as without the registry for the known types
+    const Invoice known{.customer = "BigCo"s, .performances = {{.play_id = "hamlet"s, .audience = 55}}};
+    EXPECT_EQ(statement(known, catalog, genres), statement(known, catalog));
+
+    // while without it the musicals are unknown
+    EXPECT_THROW(statement(invoice, plays), std::runtime_error);
+    EXPECT_THROW(statement(invoice, plays, GenreRegistry{}), std::runtime_error);
+}
+
+}
@@ -0,0 +1,112 @@
+#include "pch.h"
+
+#include "incremental_statement.h"
+
+#include "play_catalog.h"
+#include "render_statement.h"
+
+IncrementalStatement::IncrementalStatement(const Invoice& invoice, const PlayCatalog& plays) :
+    plays_{&plays}
+{
+    StatementCounts counts;
+    render_header(std::back_inserter(header_), invoice.customer);
+    lines_.reserve(std::size(invoice.performances));
+    for (const auto& perf : invoice.performances) {
+        const auto play_handle = counts.look_up([&] { return plays.handle_for(perf); });
+        auto& line = lines_.emplace_back(make_line(play_handle, perf.audience));
+        counts.add(0, 1, std::size(line.text));
+        total_amount_ += Money{line.amount};
+        volume_credits_ += line.volume_credits;
+    }
+    footer_ = make_footer(total_amount_, volume_credits_);
+    counts.add(1, 0, std::size(header_) + std::size(footer_));
+}
+
+void IncrementalStatement::insert(std::size_t pos, const Performance& perf)
+{
+    if (pos > size()) { throw std::out_of_range{"invalid performance position"s}; }
+
+    StatementCounts counts;
+    auto line = make_line(counts.look_up([&] { return plays_->handle_for(perf); }), perf.audience);
+    const auto total_amount = total_amount_ + Money{line.amount};
+    const auto volume_credits = volume_credits_ + line.volume_credits;
+    auto footer = make_footer(total_amount, volume_credits);
+
+    counts.add(0, 1, std::size(line.text) + std::size(footer));
+    lines_.insert(std::cbegin(lines_) + static_cast<std::ptrdiff_t>(pos), std::move(line));
+    footer_.swap(footer);
+    total_amount_ = total_amount;
+    volume_credits_ = volume_credits;
+}
+
+void IncrementalStatement::erase(std::size_t pos)
+{
+    if (pos >= size()) { throw std::out_of_range{"invalid performance position"s}; }
+
+    const auto& line = lines_[pos];
+    const auto total_amount = total_amount_ - Money{line.amount};
+    const auto volume_credits = volume_credits_ - line.volume_credits;
+    auto footer = make_footer(total_amount, volume_credits);
+
+    StatementCounts{}.add(0, 0, std::size(footer));
+    lines_.erase(std::cbegin(lines_) + static_cast<std::ptrdiff_t>(pos));
+    footer_.swap(footer);
+    total_amount_ = total_amount;
+    volume_credits_ = volume_credits;
+}
+
+void IncrementalStatement::set_audience(std::size_t pos, int audience)
+{
+    if (pos >= size()) { throw std::out_of_range{"invalid performance position"s}; }
+
+    auto& old_line = lines_[pos];
+    auto line = make_line(old_line.play_handle, audience);
+    const auto total_amount = total_amount_ - Money{old_line.amount} + Money{line.amount};
+    const auto volume_credits = volume_credits_ - old_line.volume_credits + line.volume_credits;
+    auto footer = make_footer(total_amount, volume_credits);
+
+    StatementCounts{}.add(0, 1, std::size(line.text) + std::size(footer));
+    old_line = std::move(line);
+    footer_.swap(footer);
+    total_amount_ = total_amount;
+    volume_credits_ = volume_credits;
+}
+
+std::string IncrementalStatement::str() const
+{
+    std::string out;
+    out.reserve(std::size(header_) + std::size(footer_) + std::transform_reduce(
+        std::cbegin(lines_), std::cend(lines_), std::size_t{0},
+        std::plus{}, [](const auto& line) { return std::size(line.text); }));
+    out += header_;
+    for (const auto& line : lines_) { out += line.text; }
+    out += footer_;
+    return out;
+}
+
+std::string_view IncrementalStatement::line(std::size_t pos) const
+{
+    if (pos >= size()) { throw std::out_of_range{"invalid performance position"s}; }
+    return lines_[pos].text;
+}
+
+IncrementalStatement::Line IncrementalStatement::make_line(PlayHandle play_handle, int audience) const
+{
+    const auto& play = (*plays_)[play_handle];
+    Line line{
+        .play_handle = play_handle,
+        .audience = audience,
+        .amount = amount_for(play.type, audience),
+        .volume_credits = volume_credits_for(play.type, audience),
+        .text = {}
+    };
+    render_line(std::back_inserter(line.text), play.name, line.amount, audience);
+    return line;
+}
+
+std::string IncrementalStatement::make_footer(Money total_amount, std::int64_t volume_credits)
+{
+    std::string footer;
+    render_footer(std::back_inserter(footer), total_amount, volume_credits);
+    return footer;
+}
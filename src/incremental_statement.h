@@ -0,0 +1,64 @@
+#pragma once
+
+#include "money.h"
+#include "statement.h"
+
+// Statement for an invoice being amended performance by performance,
+// which keeps the totals and the rendered lines so that an amendment re-renders
+// only the line affected and the footer rather than the whole statement.
+// The result of `str` is always the same as `statement` for the invoice as amended.
+class IncrementalStatement
+{
+public:
+    // Renders the statement for `invoice`, which need not outlive this object unlike `plays`;
+    // throws `std::out_of_range` if any play is not cataloged,
+    // `std::runtime_error` if any play is of an unknown `Play::Type`, or
+    // `std::overflow_error` if the total amount is saturated.
+    IncrementalStatement(const Invoice& invoice, const PlayCatalog& plays);
+
+    // The following leave the statement intact on failure, throwing
+    // `std::out_of_range` for an invalid position or a play not cataloged,
+    // `std::runtime_error` for a play of an unknown `Play::Type`, or
+    // `std::overflow_error` if the total amount would be saturated.
+
+    // Inserts `perf` before the performance at `pos` (or at the end if `pos` is `size()`).
+    void insert(std::size_t pos, const Performance& perf);
+    void push_back(const Performance& perf) { insert(size(), perf); }
+    // Removes the performance at `pos`.
+    void erase(std::size_t pos);
+    // Changes the audience of the performance at `pos` to `audience`.
+    void set_audience(std::size_t pos, int audience);
+
+    std::size_t size() const noexcept { return std::size(lines_); }
+    Money total_amount() const noexcept { return total_amount_; }
+    std::int64_t volume_credits() const noexcept { return volume_credits_; }
+
+    // Returns the whole statement, made of the header, the lines, and the footer.
+    std::string str() const;
+    std::string_view header() const noexcept { return header_; }
+    std::string_view line(std::size_t pos) const;
+    std::string_view footer() const noexcept { return footer_; }
+
+private:
+    // sets the totals in the tests (rather than amending millions of lines into saturation)
+    friend struct IncrementalStatementTestPeer;
+
+    struct Line
+    {
+        PlayHandle play_handle;
+        int audience;
+        std::int64_t amount;
+        std::int64_t volume_credits;
+        std::string text;
+    };
+
+    Line make_line(PlayHandle play_handle, int audience) const;
+    static std::string make_footer(Money total_amount, std::int64_t volume_credits);
+
+    const PlayCatalog* plays_;
+    std::string header_;
+    std::vector<Line> lines_;
+    std::string footer_;
+    Money total_amount_;
+    std::int64_t volume_credits_ = 0;
+};
@@ -0,0 +1,140 @@
+#include "pch.h"
+
+#include "incremental_statement.h"
+
+#include "play_catalog.h"
+
+#include <gtest/gtest.h>
+#include <gmock/gmock.h>
+
+using namespace testing;
+
+struct IncrementalStatementTestPeer
+{
+    // Sets the total amount of `incremental` as if its lines summed up to `total_amount`.
+    static void set_total_amount(IncrementalStatement& incremental, Money total_amount)
+    {
+        incremental.total_amount_ = total_amount;
+        incremental.footer_ = IncrementalStatement::make_footer(total_amount, incremental.volume_credits_);
+    }
+};
+
+namespace {
+
+const PlayCatalog plays{{
+    {"hamlet"s, {.name = "Hamlet"s, .type = Play::Type::Tragedy}},
+    {"as-like"s, {.name = "As You Like It"s, .type = Play::Type::Comedy}},
+    {"othello"s, {.name = "Othello"s, .type = Play::Type::Tragedy}},
+    {"xyz"s, {.name = "XYZ"s, .type = static_cast<Play::Type>(-1)}},
+}};
+
+TEST(IncrementalStatementTest, Amend)
+{
+    Invoice invoice{
+        .customer = "BigCo"s,
+        .performances = {
+            {
+                .play_id = "hamlet"s,
+                .audience = 55
+            },
+            {
+                .play_id = "as-like"s,
+                .audience = 35
+            },
+        }
+    };
+
+    IncrementalStatement incremental{invoice, plays};
+    EXPECT_EQ(incremental.str(), statement(invoice, plays));
+    EXPECT_EQ(incremental.total_amount(), Money{123000});
+    EXPECT_EQ(incremental.volume_credits(), 37);
+
+    const Performance othello{.play_id = "othello"s, .audience = 40};
+    incremental.insert(1, othello);
+    invoice.performances.insert(std::cbegin(invoice.performances) + 1, othello);
+    EXPECT_EQ(incremental.str(), statement(invoice, plays));
+    EXPECT_EQ(incremental.line(1), "  Othello: $500.00 (40 seats)\n"sv);
+
+    incremental.set_audience(0, 20);
+    invoice.performances[0].audience = 20;
+    EXPECT_EQ(incremental.str(), statement(invoice, plays));
+
+    incremental.erase(2);
+    invoice.performances.erase(std::cbegin(invoice.performances) + 2);
+    EXPECT_EQ(incremental.str(), statement(invoice, plays));
+
+    incremental.push_back(othello);
+    invoice.performances.push_back(othello);
+    EXPECT_EQ(incremental.str(), statement(invoice, plays));
+
+    while (incremental.size() > 0) {
+        incremental.erase(0);
+        invoice.performances.erase(std::cbegin(invoice.performances));
+        EXPECT_EQ(incremental.str(), statement(invoice, plays));
+    }
+    EXPECT_EQ(incremental.total_amount(), Money{});
+    EXPECT_EQ(incremental.volume_credits(), 0);
+}
+
+TEST(IncrementalStatementTest, Failure)
+{
+    const Invoice invoice{
+        .customer = "BigCo"s,
+        .performances = {
+            {
+                .play_id = "hamlet"s,
+                .audience = 55
+            },
+        }
+    };
+
+    IncrementalStatement incremental{invoice, plays};
+    const auto expected_text = incremental.str();
+
+    EXPECT_THROW(incremental.insert(2, {.play_id = "hamlet"s, .audience = 1}), std::out_of_range);
+    EXPECT_THROW(incremental.insert(0, {.play_id = "macbeth"s, .audience = 1}), std::out_of_range);
+    EXPECT_THROW(incremental.insert(0, {.play_id = "xyz"s, .audience = 1}), std::runtime_error);
+    EXPECT_THROW(incremental.erase(1), std::out_of_range);
+    EXPECT_THROW(incremental.set_audience(1, 10), std::out_of_range);
+    EXPECT_THROW(incremental.line(1), std::out_of_range);
+
+    EXPECT_EQ(incremental.size(), 1);
+    EXPECT_EQ(incremental.str(), expected_text);
+}
+
+TEST(IncrementalStatementTest, Saturated)
+{
+    const Invoice invoice{
+        .customer = "HugeCo"s,
+        .performances = {
+            {
+                .play_id = "hamlet"s,
+                .audience = 55
+            },
+        }
+    };
+
+    // as if so many lines had been amended that another of $650.00 would saturate the total
+    IncrementalStatement incremental{invoice, plays};
+    const Money total_amount{std::numeric_limits<std::int64_t>::max() - 65000};
+    IncrementalStatementTestPeer::set_total_amount(incremental, total_amount);
+    const auto expected_text = incremental.str();
+
+    EXPECT_THROW(incremental.push_back({.play_id = "hamlet"s, .audience = 55}), std::overflow_error);
+    EXPECT_THROW(incremental.insert(0, {.play_id = "hamlet"s, .audience = 55}), std::overflow_error);
+    // from $650.00 to $1,300.00
+    EXPECT_THROW(incremental.set_audience(0, 120), std::overflow_error);
+
+    EXPECT_EQ(incremental.size(), 1);
+    EXPECT_EQ(incremental.total_amount(), total_amount);
+    EXPECT_EQ(incremental.str(), expected_text);
+
+    // and can still be amended within the limit
+    incremental.push_back({.play_id = "hamlet"s, .audience = 30});
+    incremental.set_audience(0, 30);
+    incremental.erase(0);
+    EXPECT_EQ(incremental.size(), 1);
+    EXPECT_EQ(incremental.total_amount(), total_amount - Money{65000} + Money{40000});
+}
+
+}
@@ -0,0 +1,106 @@
+#include "pch.h"
+
+#include "instrumentation.h"
+
+namespace {
+
+std::atomic<bool> metrics_enabled = false;
+
+// Counts of `StatementMetrics` (with the durations in ticks) updated concurrently
+struct AtomicMetrics
+{
+    std::atomic<std::uint64_t> statements;
+    std::atomic<std::uint64_t> lines;
+    std::atomic<std::uint64_t> bytes;
+    std::atomic<std::uint64_t> catalog_misses;
+    std::atomic<StatementMetrics::Duration::rep> lookup;
+    std::atomic<StatementMetrics::Duration::rep> pricing;
+    std::atomic<StatementMetrics::Duration::rep> currency;
+    std::atomic<StatementMetrics::Duration::rep> formatting;
+};
+
+AtomicMetrics collected;
+
+StatementMetrics load_or_exchange(bool reset) noexcept
+{
+    auto take = [reset](auto& counter) { return reset ? counter.exchange(0) : counter.load(); };
+    StatementMetrics metrics;
+    metrics.statements = take(collected.statements);
+    metrics.lines = take(collected.lines);
+    metrics.bytes = take(collected.bytes);
+    metrics.catalog_misses = take(collected.catalog_misses);
+    metrics.lookup = StatementMetrics::Duration{take(collected.lookup)};
+    metrics.pricing = StatementMetrics::Duration{take(collected.pricing)};
+    metrics.currency = StatementMetrics::Duration{take(collected.currency)};
+    metrics.formatting = StatementMetrics::Duration{take(collected.formatting)};
+    return metrics;
+}
+
+}
+
+StatementMetrics& StatementMetrics::operator+=(const StatementMetrics& other) noexcept
+{
+    statements += other.statements;
+    lines += other.lines;
+    bytes += other.bytes;
+    catalog_misses += other.catalog_misses;
+    lookup += other.lookup;
+    pricing += other.pricing;
+    currency += other.currency;
+    formatting += other.formatting;
+    return *this;
+}
+
+void enable_statement_metrics(bool enabled) noexcept
+{
+    metrics_enabled.store(enabled, std::memory_order_relaxed);
+}
+
+bool statement_metrics_enabled() noexcept
+{
+    return metrics_enabled.load(std::memory_order_relaxed);
+}
+
+void add_statement_metrics(const StatementMetrics& metrics) noexcept
+{
+    constexpr auto relaxed = std::memory_order_relaxed;
+    collected.statements.fetch_add(metrics.statements, relaxed);
+    collected.lines.fetch_add(metrics.lines, relaxed);
+    collected.bytes.fetch_add(metrics.bytes, relaxed);
+    collected.catalog_misses.fetch_add(metrics.catalog_misses, relaxed);
+    collected.lookup.fetch_add(metrics.lookup.count(), relaxed);
+    collected.pricing.fetch_add(metrics.pricing.count(), relaxed);
+    collected.currency.fetch_add(metrics.currency.count(), relaxed);
+    collected.formatting.fetch_add(metrics.formatting.count(), relaxed);
+}
+
+StatementMetrics statement_metrics() noexcept
+{
+    return load_or_exchange(false);
+}
+
+StatementMetrics reset_statement_metrics() noexcept
+{
+    return load_or_exchange(true);
+}
+
+void write_statement_metrics(std::ostream& os, const StatementMetrics& metrics)
+{
+    auto seconds = [](StatementMetrics::Duration duration)
+    {
+        return std::chrono::duration<double>{duration}.count();
+    };
+
+    os << std::format(
+        "statement_statements_total {}\n"
+        "statement_lines_total {}\n"
+        "statement_bytes_total {}\n"
+        "statement_catalog_misses_total {}\n"
+        "statement_lookup_seconds_total {}\n"
+        "statement_pricing_seconds_total {}\n"
+        "statement_currency_seconds_total {}\n"
+        "statement_formatting_seconds_total {}\n"sv,
+        metrics.statements, metrics.lines, metrics.bytes, metrics.catalog_misses,
+        seconds(metrics.lookup), seconds(metrics.pricing),
+        seconds(metrics.currency), seconds(metrics.formatting));
+}
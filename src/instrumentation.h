@@ -0,0 +1,88 @@
+#pragma once
+
+// Counters and timers of the hot paths of rendering statements, collected process-wide
+// only while enabled (and otherwise costing a check per statement);
+// each rendering accumulates its own and adds them up once when done (or failed).
+// Every path of rendering (`statement`, `statements` of any kind, `customer_statements`,
+// `StreamingStatement`, and `IncrementalStatement`) counts the statements, the lines, and
+// the bytes it renders (cached lines included) and the catalog misses, whereas only those
+// rendering whole statements by `render_statement` time the phases (i.e., not the error-recording,
+// cached, streaming, nor incremental ones, nor the invoices split among threads).
+// An `IncrementalStatement` counts a statement when constructed and
+// the lines and the footers it re-renders when amended.
+struct StatementMetrics
+{
+    using Duration = std::chrono::steady_clock::duration;
+
+    std::uint64_t statements = 0;
+    std::uint64_t lines = 0;
+    std::uint64_t bytes = 0;
+    // lookups of plays that are not found
+    std::uint64_t catalog_misses = 0;
+
+    // time spent in looking up plays, pricing performances,
+    // formatting currency, and formatting the rest of the text
+    Duration lookup{};
+    Duration pricing{};
+    Duration currency{};
+    Duration formatting{};
+
+    StatementMetrics& operator+=(const StatementMetrics& other) noexcept;
+};
+
+// Enables (or disables) collecting `StatementMetrics`, which is disabled by default;
+// timing each phase of each line, the rendering becomes slower while enabled.
+void enable_statement_metrics(bool enabled) noexcept;
+bool statement_metrics_enabled() noexcept;
+
+// Adds `metrics` to those collected so far.
+void add_statement_metrics(const StatementMetrics& metrics) noexcept;
+
+// Counts of `StatementMetrics` (without the durations) accumulated by a rendering
+// if enabled when constructed, and added to those collected when destroyed (done or failed).
+class StatementCounts
+{
+public:
+    StatementCounts() noexcept : enabled_{statement_metrics_enabled()} {}
+    StatementCounts(const StatementCounts&) = delete;
+    StatementCounts& operator=(const StatementCounts&) = delete;
+    ~StatementCounts()
+    {
+        if (enabled_) { add_statement_metrics(metrics_); }
+    }
+
+    // Counts `statements` statements (zero for a part of one) of `lines` lines in `bytes` bytes.
+    void add(std::uint64_t statements, std::uint64_t lines, std::uint64_t bytes) noexcept
+    {
+        metrics_.statements += statements;
+        metrics_.lines += lines;
+        metrics_.bytes += bytes;
+    }
+
+    void add_catalog_miss() noexcept { ++metrics_.catalog_misses; }
+
+    // Returns `lookup()` (of a play), counting a catalog miss if it throws `std::out_of_range`.
+    template<typename Lookup>
+    decltype(auto) look_up(Lookup lookup)
+    {
+        try {
+            return lookup();
+        }
+        catch (const std::out_of_range&) {
+            add_catalog_miss();
+            throw;
+        }
+    }
+
+private:
+    bool enabled_;
+    StatementMetrics metrics_;
+};
+
+// Returns the metrics collected so far; `reset_statement_metrics` also resets them to zero.
+StatementMetrics statement_metrics() noexcept;
+StatementMetrics reset_statement_metrics() noexcept;
+
+// Writes `metrics` to `os` one per line in the text format that Prometheus scrapes
+// (e.g., "statement_lines_total 42"), with the durations in seconds.
+void write_statement_metrics(std::ostream& os, const StatementMetrics& metrics);
@@ -0,0 +1,220 @@
+#include "pch.h"
+
+#include "instrumentation.h"
+
+#include "customer_statements.h"
+#include "incremental_statement.h"
+#include "line_cache.h"
+#include "play_catalog.h"
+#include "statement.h"
+#include "streaming_statement.h"
+
+#include <gtest/gtest.h>
+#include <gmock/gmock.h>
+
+using namespace testing;
+
+namespace {
+
+const std::map<std::string, Play> plays{
+    {"hamlet"s, {.name = "Hamlet"s, .type = Play::Type::Tragedy}},
+    {"as-like"s, {.name = "As You Like It"s, .type = Play::Type::Comedy}},
+};
+
+const Invoice invoice{
+    .customer = "BigCo"s,
+    .performances = {
+        {
+            .play_id = "hamlet"s,
+            .audience = 55
+        },
+        {
+            .play_id = "as-like"s,
+            .audience = 35
+        },
+    }
+};
+
+// Enables `StatementMetrics` (starting from zero) while alive
+class MetricsEnabled
+{
+public:
+    MetricsEnabled()
+    {
+        reset_statement_metrics();
+        enable_statement_metrics(true);
+    }
+    ~MetricsEnabled() { enable_statement_metrics(false); }
+};
+
+TEST(InstrumentationTest, Disabled)
+{
+    reset_statement_metrics();
+    EXPECT_FALSE(statement_metrics_enabled());
+    statement(invoice, plays);
+
+    const auto metrics = statement_metrics();
+    EXPECT_EQ(metrics.statements, 0);
+    EXPECT_EQ(metrics.lines, 0);
+}
+
+TEST(InstrumentationTest, Enabled)
+{
+    const auto expected_text = statement(invoice, plays);
+
+    const MetricsEnabled enabled;
+    EXPECT_EQ(statement(invoice, plays), expected_text);
+
+    std::ostringstream oss;
+    statements(std::span{&invoice, 1}, plays, oss);
+    EXPECT_EQ(oss.str(), expected_text);
+
+    const auto metrics = reset_statement_metrics();
+    EXPECT_EQ(metrics.statements, 2);
+    EXPECT_EQ(metrics.lines, 4);
+    EXPECT_EQ(metrics.bytes, 2 * std::size(expected_text));
+    EXPECT_EQ(metrics.catalog_misses, 0);
+    EXPECT_GT(metrics.formatting, StatementMetrics::Duration::zero());
+
+    EXPECT_EQ(statement_metrics().statements, 0);
+}
+
+TEST(InstrumentationTest, CatalogMiss)
+{
+    const MetricsEnabled enabled;
+
+    auto unknown = invoice;
+    unknown.performances.push_back({.play_id = "macbeth"s, .audience = 10});
+    EXPECT_THROW(statement(unknown, plays), std::out_of_range);
+
+    const auto metrics = statement_metrics();
+    EXPECT_EQ(metrics.statements, 0);
+    EXPECT_EQ(metrics.lines, 2);
+    EXPECT_EQ(metrics.catalog_misses, 1);
+}
+
+TEST(InstrumentationTest, StatementsWithErrors)
+{
+    const auto expected_text = statement(invoice, plays);
+    auto unknown = invoice;
+    unknown.performances.push_back({.play_id = "macbeth"s, .audience = 10});
+    const std::vector invoices{invoice, unknown};
+
+    const MetricsEnabled enabled;
+    std::string out;
+    std::vector<StatementError> errors;
+    statements(invoices, plays, out, errors);
+    EXPECT_EQ(out, expected_text);
+    EXPECT_EQ(std::size(errors), 1);
+
+    // as `statement` counts the lines rendered before failing (without the footer)
+    const auto metrics = statement_metrics();
+    EXPECT_EQ(metrics.statements, 1);
+    EXPECT_EQ(metrics.lines, 4);
+    EXPECT_EQ(metrics.bytes, std::size(expected_text) + expected_text.find("Amount owed"sv));
+    EXPECT_EQ(metrics.catalog_misses, 1);
+}
+
+// Expects the metrics collected (and resets them) to count `invoices` rendered into `text`
+void expect_counted(std::span<const Invoice> invoices, std::string_view text)
+{
+    const auto metrics = reset_statement_metrics();
+    EXPECT_EQ(metrics.statements, std::size(invoices));
+    EXPECT_EQ(metrics.lines, std::transform_reduce(
+        std::cbegin(invoices), std::cend(invoices), std::uint64_t{0},
+        std::plus{}, [](const auto& invoice) { return std::size(invoice.performances); }));
+    EXPECT_EQ(metrics.bytes, std::size(text));
+    EXPECT_EQ(metrics.catalog_misses, 0);
+}
+
+TEST(InstrumentationTest, EveryPath)
+{
+    const PlayCatalog catalog{plays};
+    auto large = invoice;
+    large.customer = "MegaCo"s;
+    for (int i = 0; i < 1000; ++i) {
+        large.performances.push_back({.play_id = i % 2 ? "hamlet"s : "as-like"s, .audience = i % 60});
+    }
+    const std::vector invoices{invoice, large};
+    std::string expected_text;
+    statements(invoices, catalog, expected_text);
+
+    const MetricsEnabled enabled;
+    std::string out;
+    statements(std::execution::par, invoices, catalog, out);
+    EXPECT_EQ(out, expected_text);
+    expect_counted(invoices, out);
+
+    LineCache cache{100};
+    out.clear();
+    statements(invoices, catalog, cache, out);
+    EXPECT_EQ(out, expected_text);
+    expect_counted(invoices, out);
+
+    out.clear();
+    statements(std::execution::par, invoices, catalog, cache, out);
+    EXPECT_EQ(out, expected_text);
+    expect_counted(invoices, out);
+
+    out.clear();
+    for (const auto& customer : customer_statements(invoices, catalog)) { out += customer.text; }
+    EXPECT_EQ(out, expected_text);
+    expect_counted(invoices, out);
+
+    std::ostringstream oss;
+    for (const auto& each : invoices) {
+        StreamingStatement streaming{each.customer, catalog, oss};
+        streaming.add(each.performances);
+        streaming.finish();
+    }
+    EXPECT_EQ(oss.str(), expected_text);
+    expect_counted(invoices, oss.str());
+
+    out.clear();
+    for (const auto& each : invoices) { out += IncrementalStatement{each, catalog}.str(); }
+    EXPECT_EQ(out, expected_text);
+    expect_counted(invoices, out);
+}
+
+TEST(InstrumentationTest, IncrementalStatement)
+{
+    const PlayCatalog catalog{plays};
+    IncrementalStatement incremental{invoice, catalog};
+
+    const MetricsEnabled enabled;
+    incremental.set_audience(0, 60);
+    auto metrics = reset_statement_metrics();
+    EXPECT_EQ(metrics.statements, 0);
+    EXPECT_EQ(metrics.lines, 1);
+    EXPECT_EQ(metrics.bytes, std::size(incremental.line(0)) + std::size(incremental.footer()));
+
+    incremental.erase(0);
+    metrics = reset_statement_metrics();
+    EXPECT_EQ(metrics.lines, 0);
+    EXPECT_EQ(metrics.bytes, std::size(incremental.footer()));
+
+    EXPECT_THROW(incremental.insert(0, {.play_id = "macbeth"s, .audience = 10}), std::out_of_range);
+    metrics = reset_statement_metrics();
+    EXPECT_EQ(metrics.lines, 0);
+    EXPECT_EQ(metrics.catalog_misses, 1);
+}
+
+TEST(InstrumentationTest, WriteStatementMetrics)
+{
+    StatementMetrics metrics;
+    metrics.statements = 1;
+    metrics.lines = 2;
+    metrics.bytes = 100;
+    metrics.pricing = std::chrono::milliseconds{1500};
+
+    std::ostringstream oss;
+    write_statement_metrics(oss, metrics);
+
+    EXPECT_THAT(oss.str(), HasSubstr("statement_statements_total 1\n"s));
+    EXPECT_THAT(oss.str(), HasSubstr("statement_lines_total 2\n"s));
+    EXPECT_THAT(oss.str(), HasSubstr("statement_bytes_total 100\n"s));
+    EXPECT_THAT(oss.str(), HasSubstr("statement_catalog_misses_total 0\n"s));
+    EXPECT_THAT(oss.str(), HasSubstr("statement_pricing_seconds_total 1.5\n"s));
+}
+
+}
@@ -0,0 +1,174 @@
+#include "pch.h"
+
+#include "invoice_archive.h"
+
+#include "play_catalog.h"
+#include "render_statement.h"
+
+namespace {
+
+static_assert(sizeof(ArchiveHeader) % 8 == 0);
+static_assert(sizeof(ArchivedPlayRecord) % 8 == 0);
+static_assert(sizeof(ArchivedInvoiceRecord) % 8 == 0);
+static_assert(sizeof(ArchivedPerformance) % 8 == 0);
+static_assert(sizeof(Play::Type) == sizeof(std::int32_t));
+
+[[noreturn]] void throw_corrupted()
+{
+    throw std::out_of_range{"corrupted invoice archive"s};
+}
+
+// Takes `count` records of type `T` off the front of `bytes`
+template<typename T>
+std::span<const T> take_section(std::span<const std::byte>& bytes, std::uint64_t count)
+{
+    if (count > std::size(bytes) / sizeof(T)) { throw std::runtime_error{"truncated invoice archive"s}; }
+    const auto size = static_cast<std::size_t>(count);
+    const std::span records{reinterpret_cast<const T*>(std::data(bytes)), size};
+    bytes = bytes.subspan(size * sizeof(T));
+    return records;
+}
+
+template<typename T, std::size_t Extent>
+void write_section(std::ostream& os, std::span<T, Extent> records)
+{
+    os.write(reinterpret_cast<const char*>(std::data(records)), static_cast<std::streamsize>(records.size_bytes()));
+}
+
+}
+
+void write_invoice_archive(std::ostream& os, std::span<const Invoice> invoices, const PlayCatalog& plays)
+{
+    std::string strings;
+    auto add_string = [&](std::string_view str)
+    {
+        const ArchivedString archived{.offset = std::size(strings), .size = std::size(str)};
+        strings += str;
+        return archived;
+    };
+
+    std::vector<ArchivedPlayRecord> play_records;
+    play_records.reserve(plays.size());
+    for (std::size_t i = 0; i < plays.size(); ++i) {
+        const auto handle = static_cast<PlayHandle>(i);
+        play_records.push_back({
+            .id = add_string(plays.id(handle)),
+            .name = add_string(plays[handle].name),
+            .type = static_cast<std::int32_t>(plays[handle].type),
+            .reserved = 0
+        });
+    }
+
+    std::vector<ArchivedInvoiceRecord> invoice_records;
+    std::vector<ArchivedPerformance> performances;
+    invoice_records.reserve(std::size(invoices));
+    for (const auto& invoice : invoices) {
+        invoice_records.push_back({
+            .customer = add_string(invoice.customer),
+            .first_performance = std::size(performances),
+            .num_performances = std::size(invoice.performances)
+        });
+        for (const auto& perf : invoice.performances) {
+            performances.push_back({.play_handle = plays.handle_for(perf), .audience = perf.audience});
+        }
+    }
+
+    const ArchiveHeader header{
+        .magic = ArchiveHeader::expected_magic,
+        .version = ArchiveHeader::current_version,
+        .reserved = 0,
+        .num_plays = std::size(play_records),
+        .num_invoices = std::size(invoice_records),
+        .num_performances = std::size(performances),
+        .strings_size = std::size(strings)
+    };
+
+    write_section(os, std::span{&header, 1});
+    write_section(os, std::span{play_records});
+    write_section(os, std::span{invoice_records});
+    write_section(os, std::span{performances});
+    os.write(std::data(strings), static_cast<std::streamsize>(std::size(strings)));
+}
+
+InvoiceArchive::InvoiceArchive(std::span<const std::byte> bytes)
+{
+    if (reinterpret_cast<std::uintptr_t>(std::data(bytes)) % alignof(std::uint64_t) != 0) {
+        throw std::runtime_error{"misaligned invoice archive"s};
+    }
+
+    const auto& header = take_section<ArchiveHeader>(bytes, 1).front();
+    if (header.magic != ArchiveHeader::expected_magic) {
+        throw std::runtime_error{"not an invoice archive"s};
+    }
+    if (header.version != ArchiveHeader::current_version) {
+        throw std::runtime_error{std::format("{}: unsupported invoice archive version"sv, header.version)};
+    }
+
+    plays_ = take_section<ArchivedPlayRecord>(bytes, header.num_plays);
+    invoices_ = take_section<ArchivedInvoiceRecord>(bytes, header.num_invoices);
+    performances_ = take_section<ArchivedPerformance>(bytes, header.num_performances);
+    const auto strings = take_section<char>(bytes, header.strings_size);
+    strings_ = {std::data(strings), std::size(strings)};
+}
+
+ArchivedPlay InvoiceArchive::play(PlayHandle handle) const
+{
+    const auto index = static_cast<std::size_t>(handle);
+    if (index >= std::size(plays_)) { throw std::out_of_range{"invalid play handle"s}; }
+
+    const auto& record = plays_[index];
+    return {
+        .id = string(record.id),
+        .name = string(record.name),
+        .type = static_cast<Play::Type>(record.type)
+    };
+}
+
+ArchivedInvoice InvoiceArchive::operator[](std::size_t i) const
+{
+    if (i >= std::size(invoices_)) { throw std::out_of_range{"invalid invoice index"s}; }
+
+    const auto& record = invoices_[i];
+    if (record.first_performance > std::size(performances_) ||
+        record.num_performances > std::size(performances_) - record.first_performance) {
+        throw_corrupted();
+    }
+    return {
+        .customer = string(record.customer),
+        .performances = performances_.subspan(
+            static_cast<std::size_t>(record.first_performance),
+            static_cast<std::size_t>(record.num_performances))
+    };
+}
+
+std::string_view InvoiceArchive::string(const ArchivedString& str) const
+{
+    if (str.offset > std::size(strings_) || str.size > std::size(strings_) - str.offset) {
+        throw_corrupted();
+    }
+    return strings_.substr(static_cast<std::size_t>(str.offset), static_cast<std::size_t>(str.size));
+}
+
+ArchivedPlay play_for(const InvoiceArchive& plays, const ArchivedPerformance& perf)
+{
+    return plays.play(perf.play_handle);
+}
+
+std::string statement(const ArchivedInvoice& invoice, const InvoiceArchive& archive)
+{
+    std::string out;
+    out.reserve(estimated_statement_size(invoice));
+    render_statement(std::back_inserter(out), invoice, archive);
+    return out;
+}
+
+void statements(const InvoiceArchive& archive, std::string& out)
+{
+    std::size_t size = 0;
+    for (std::size_t i = 0; i < archive.size(); ++i) { size += estimated_statement_size(archive[i]); }
+    out.reserve(std::size(out) + size);
+
+    for (std::size_t i = 0; i < archive.size(); ++i) {
+        render_statement(std::back_inserter(out), archive[i], archive);
+    }
+}
@@ -0,0 +1,109 @@
+#pragma once
+
+#include "statement.h"
+
+// Binary format of invoices together with the catalog of their plays,
+// designed to be memory-mapped (see `MappedFile`) and read in place by `InvoiceArchive`.
+// The sections below follow one another, each in native byte order and 8-byte aligned:
+//
+//     ArchiveHeader
+//     ArchivedPlayRecord[num_plays]
+//     ArchivedInvoiceRecord[num_invoices]
+//     ArchivedPerformance[num_performances]  (of all the invoices one after another)
+//     char[strings_size]                     (string table of IDs, names, and customers)
+//
+// where each performance refers to its play by the index into the plays (i.e., interned ID).
+
+struct ArchivedString
+{
+    std::uint64_t offset; // into the string table
+    std::uint64_t size;
+};
+
+struct ArchiveHeader
+{
+    static constexpr std::array<char, 8> expected_magic{'S', 'T', 'M', 'T', 'A', 'R', 'C', 'H'};
+    static constexpr std::uint32_t current_version = 1;
+
+    std::array<char, 8> magic;
+    std::uint32_t version;
+    std::uint32_t reserved;
+    std::uint64_t num_plays;
+    std::uint64_t num_invoices;
+    std::uint64_t num_performances;
+    std::uint64_t strings_size;
+};
+
+struct ArchivedPlayRecord
+{
+    ArchivedString id;
+    ArchivedString name;
+    std::int32_t type;
+    std::uint32_t reserved;
+};
+
+struct ArchivedInvoiceRecord
+{
+    ArchivedString customer;
+    std::uint64_t first_performance;
+    std::uint64_t num_performances;
+};
+
+struct ArchivedPerformance
+{
+    PlayHandle play_handle;
+    std::int32_t audience;
+};
+
+// Play in place in an archive
+struct ArchivedPlay
+{
+    std::string_view id;
+    std::string_view name;
+    Play::Type type;
+};
+
+// Invoice in place in an archive
+struct ArchivedInvoice
+{
+    std::string_view customer;
+    std::span<const ArchivedPerformance> performances;
+};
+
+// Writes `invoices` to `os` in the archive format, interning their plays in `plays`;
+// throws `std::out_of_range` if any play is not cataloged.
+void write_invoice_archive(std::ostream& os, std::span<const Invoice> invoices, const PlayCatalog& plays);
+
+// Non-owning view of an archive, reading records in place without deserializing.
+// Only the section sizes are validated on construction (so as to be O(1) no matter the size),
+// whereas each record is validated on access.
+class InvoiceArchive
+{
+public:
+    // Views `bytes` as an archive, which must be 8-byte aligned and outlive the view;
+    // throws `std::runtime_error` if the sections do not fit in `bytes`.
+    explicit InvoiceArchive(std::span<const std::byte> bytes);
+
+    std::size_t num_plays() const noexcept { return std::size(plays_); }
+    // Throws `std::out_of_range` for an invalid handle or a corrupted record.
+    ArchivedPlay play(PlayHandle handle) const;
+
+    std::size_t size() const noexcept { return std::size(invoices_); }
+    // Throws `std::out_of_range` for an invalid index or a corrupted record.
+    ArchivedInvoice operator[](std::size_t i) const;
+
+private:
+    std::string_view string(const ArchivedString& str) const;
+
+    std::span<const ArchivedPlayRecord> plays_;
+    std::span<const ArchivedInvoiceRecord> invoices_;
+    std::span<const ArchivedPerformance> performances_;
+    std::string_view strings_;
+};
+
+// Returns the play for `perf`; throws `std::out_of_range` if not found in `plays`.
+ArchivedPlay play_for(const InvoiceArchive& plays, const ArchivedPerformance& perf);
+
+// Render the statement(s) for (all) the invoices in `archive` as `statement` does.
+std::string statement(const ArchivedInvoice& invoice, const InvoiceArchive& archive);
+void statements(const InvoiceArchive& archive, std::string& out);
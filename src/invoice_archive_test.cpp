@@ -0,0 +1,159 @@
+#include "pch.h"
+
+#include "invoice_archive.h"
+
+#include "mapped_file.h"
+#include "play_catalog.h"
+
+#include <gtest/gtest.h>
+#include <gmock/gmock.h>
+
+using namespace testing;
+
+namespace {
+
+const PlayCatalog plays{{
+    {"hamlet"s, {.name = "Hamlet"s, .type = Play::Type::Tragedy}},
+    {"as-like"s, {.name = "As You Like It"s, .type = Play::Type::Comedy}},
+    {"othello"s, {.name = "Othello"s, .type = Play::Type::Tragedy}},
+}};
+
+const std::vector<Invoice> invoices{
+    {
+        .customer = "BigCo"s,
+        .performances = {
+            {
+                .play_id = "hamlet"s,
+                .audience = 55
+            },
+            {
+                .play_id = "as-like"s,
+                .audience = 35
+            },
+            {
+                .play_id = "othello"s,
+                .audience = 40
+            },
+        }
+    },
+    {
+        .customer = "NoCo"s,
+        .performances = {}
+    },
+    {
+        .customer = "SmallCo"s,
+        .performances = {
+            {
+                .play_id = "as-like"s,
+                .audience = 10
+            },
+        }
+    },
+};
+
+// Archive bytes copied into 8-byte aligned storage
+class AlignedBytes
+{
+public:
+    explicit AlignedBytes(std::string_view str) :
+        storage_((std::size(str) + 7) / 8),
+        size_{std::size(str)}
+    {
+        std::memcpy(std::data(storage_), std::data(str), std::size(str));
+    }
+
+    std::span<const std::byte> bytes() const noexcept
+    {
+        return {reinterpret_cast<const std::byte*>(std::data(storage_)), size_};
+    }
+
+private:
+    std::vector<std::uint64_t> storage_;
+    std::size_t size_;
+};
+
+std::string archive_bytes()
+{
+    std::ostringstream oss;
+    write_invoice_archive(oss, invoices, plays);
+    return std::move(oss).str();
+}
+
+TEST(InvoiceArchiveTest, RoundTrip)
+{
+    const AlignedBytes bytes{archive_bytes()};
+    const InvoiceArchive archive{bytes.bytes()};
+
+    ASSERT_EQ(archive.num_plays(), plays.size());
+    for (std::size_t i = 0; i < plays.size(); ++i) {
+        const auto handle = static_cast<PlayHandle>(i);
+        const auto play = archive.play(handle);
+        EXPECT_EQ(play.id, plays.id(handle));
+        EXPECT_EQ(play.name, plays[handle].name);
+        EXPECT_EQ(play.type, plays[handle].type);
+    }
+
+    ASSERT_EQ(archive.size(), std::size(invoices));
+    std::string expected_text;
+    for (std::size_t i = 0; i < std::size(invoices); ++i) {
+        const auto invoice = archive[i];
+        EXPECT_EQ(invoice.customer, invoices[i].customer);
+        ASSERT_EQ(std::size(invoice.performances), std::size(invoices[i].performances));
+        for (std::size_t j = 0; j < std::size(invoice.performances); ++j) {
+            EXPECT_EQ(archive.play(invoice.performances[j].play_handle).id, invoices[i].performances[j].play_id);
+            EXPECT_EQ(invoice.performances[j].audience, invoices[i].performances[j].audience);
+        }
+
+        const auto text = statement(invoices[i], plays);
+        EXPECT_EQ(statement(invoice, archive), text);
+        expected_text += text;
+    }
+
+    std::string actual_text;
+    statements(archive, actual_text);
+    EXPECT_EQ(actual_text, expected_text);
+}
+
+TEST(InvoiceArchiveTest, MappedFile)
+{
+    const auto path = std::filesystem::temp_directory_path() / "invoice_archive_test.bin";
+    {
+        std::ofstream ofs{path, std::ios_base::binary};
+        write_invoice_archive(ofs, invoices, plays);
+    }
+
+    std::string actual_text;
+    {
+        const MappedFile file{path};
+        statements(InvoiceArchive{file.bytes()}, actual_text);
+    }
+    std::filesystem::remove(path);
+
+    std::string expected_text;
+    statements(invoices, plays, expected_text);
+    EXPECT_EQ(actual_text, expected_text);
+}
+
+TEST(InvoiceArchiveTest, Malformed)
+{
+    const auto str = archive_bytes();
+
+    EXPECT_THAT(
+        [&] { InvoiceArchive{AlignedBytes{str.substr(0, std::size(str) - 1)}.bytes()}; },
+        ThrowsMessage<std::runtime_error>(Eq("truncated invoice archive"s)));
+    EXPECT_THAT(
+        [&] { InvoiceArchive{AlignedBytes{std::string(sizeof(ArchiveHeader), 'x')}.bytes()}; },
+        ThrowsMessage<std::runtime_error>(Eq("not an invoice archive"s)));
+
+    // corrupt the string table offset of the first customer
+    auto corrupted = str;
+    const auto offset = sizeof(ArchiveHeader) + plays.size() * sizeof(ArchivedPlayRecord);
+    corrupted[offset + offsetof(ArchivedInvoiceRecord, customer)] = '\xff';
+    const AlignedBytes bytes{corrupted};
+    const InvoiceArchive archive{bytes.bytes()};
+    EXPECT_THROW(archive[0], std::out_of_range);
+    EXPECT_THROW(archive[std::size(invoices)], std::out_of_range);
+    EXPECT_THROW(archive.play(static_cast<PlayHandle>(plays.size())), std::out_of_range);
+}
+
+}
@@ -0,0 +1,75 @@
+#include "pch.h"
+
+#include "line_cache.h"
+
+LineCache::LineCache(std::size_t capacity) :
+    shard_capacity_{(capacity + num_shards - 1) / num_shards}
+{
+    if (capacity == 0) { throw std::invalid_argument{"zero line cache capacity"s}; }
+}
+
+std::optional<LinePrice> LineCache::append_to(PlayHandle handle, int audience, std::string& out)
+{
+    const auto key = key_of(handle, audience);
+    auto& shard = shard_for(key);
+    const std::lock_guard lock{shard.mutex};
+
+    const auto it = shard.entries.find(key);
+    if (it == std::cend(shard.entries)) {
+        ++shard.misses;
+        return std::nullopt;
+    }
+    out += it->second.text;
+    ++shard.hits;
+    return it->second.price;
+}
+
+void LineCache::insert(PlayHandle handle, int audience, std::string_view text, LinePrice price)
+{
+    const auto key = key_of(handle, audience);
+    auto& shard = shard_for(key);
+    // allocate the text before taking the lock
+    Entry entry{.text = std::string{text}, .price = price};
+    const std::lock_guard lock{shard.mutex};
+
+    if (shard.entries.contains(key)) { return; }
+    if (std::size(shard.order) < shard_capacity_) {
+        shard.order.push_back(key);
+        try {
+            shard.entries.emplace(key, std::move(entry));
+        }
+        catch (...) {
+            shard.order.pop_back();
+            throw;
+        }
+    }
+    else {
+        // evict the oldest to reuse its node
+        auto node = shard.entries.extract(shard.order[shard.oldest]);
+        node.key() = key;
+        node.mapped() = std::move(entry);
+        shard.entries.insert(std::move(node));
+        shard.order[shard.oldest] = key;
+        shard.oldest = (shard.oldest + 1) % shard_capacity_;
+    }
+}
+
+LineCache::Stats LineCache::stats() const
+{
+    Stats stats{.hits = 0, .misses = 0, .size = 0};
+    for (const auto& shard : shards_) {
+        const std::lock_guard lock{shard.mutex};
+        stats.hits += shard.hits;
+        stats.misses += shard.misses;
+        stats.size += std::size(shard.entries);
+    }
+    return stats;
+}
+
+LineCache::Shard& LineCache::shard_for(std::uint64_t key) noexcept
+{
+    // Fibonacci hashing so that consecutive audiences spread over the shards
+    static_assert(std::has_single_bit(num_shards));
+    constexpr auto shift = 64 - std::countr_zero(num_shards);
+    return shards_[static_cast<std::size_t>((key * 0x9E3779B97F4A7C15ull) >> shift)];
+}
@@ -0,0 +1,68 @@
+#pragma once
+
+#include "statement.h"
+
+struct LinePrice
+{
+    std::int64_t amount;
+    std::int64_t volume_credits;
+};
+
+// Bounded cache of the rendered lines of statements keyed by the play handle and the audience,
+// which can be shared among threads rendering statements with the same `PlayCatalog`
+// (see `statements` taking a `LineCache`).
+// Once full, the oldest entries are evicted first; the hits and the misses are counted
+// so that the capacity can be tuned.
+class LineCache
+{
+public:
+    struct Stats
+    {
+        std::uint64_t hits;
+        std::uint64_t misses;
+        std::size_t size;
+    };
+
+    // Holds up to about `capacity` lines; throws `std::invalid_argument` if `capacity` is zero.
+    explicit LineCache(std::size_t capacity);
+
+    // Appends the line for `audience` seats of the play with `handle` to `out`
+    // and returns its price if cached; counts a hit or a miss.
+    std::optional<LinePrice> append_to(PlayHandle handle, int audience, std::string& out);
+
+    // Caches `text` as the line for `audience` seats of the play with `handle`
+    // unless already cached.
+    void insert(PlayHandle handle, int audience, std::string_view text, LinePrice price);
+
+    Stats stats() const;
+
+private:
+    struct Entry
+    {
+        std::string text;
+        LinePrice price;
+    };
+
+    // Part of the cache guarded by one mutex so that threads rarely contend
+    struct Shard
+    {
+        mutable std::mutex mutex;
+        std::unordered_map<std::uint64_t, Entry> entries;
+        // keys in the order of insertion, used as a ring buffer once full
+        std::vector<std::uint64_t> order;
+        std::size_t oldest = 0;
+        std::uint64_t hits = 0;
+        std::uint64_t misses = 0;
+    };
+
+    static constexpr std::size_t num_shards = 16;
+
+    static std::uint64_t key_of(PlayHandle handle, int audience) noexcept
+    {
+        return static_cast<std::uint64_t>(handle) << 32 | static_cast<std::uint32_t>(audience);
+    }
+    Shard& shard_for(std::uint64_t key) noexcept;
+
+    std::size_t shard_capacity_;
+    std::array<Shard, num_shards> shards_;
+};
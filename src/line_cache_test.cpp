@@ -0,0 +1,160 @@
+#include "pch.h"
+
+#include "line_cache.h"
+
+#include "play_catalog.h"
+
+#include <gtest/gtest.h>
+#include <gmock/gmock.h>
+
+using namespace testing;
+
+namespace {
+
+TEST(LineCacheTest, AppendTo)
+{
+    LineCache cache{100};
+    const auto handle = static_cast<PlayHandle>(1);
+
+    std::string out = "> "s;
+    EXPECT_EQ(cache.append_to(handle, 55, out), std::nullopt);
+    cache.insert(handle, 55, "  Hamlet: $650.00 (55 seats)\n"sv, {.amount = 65000, .volume_credits = 25});
+
+    const auto price = cache.append_to(handle, 55, out);
+    ASSERT_TRUE(price);
+    EXPECT_EQ(price->amount, 65000);
+    EXPECT_EQ(price->volume_credits, 25);
+    EXPECT_EQ(out, "> " "  Hamlet: $650.00 (55 seats)\n"s);
+
+    EXPECT_EQ(cache.append_to(handle, 56, out), std::nullopt);
+    EXPECT_EQ(cache.append_to(static_cast<PlayHandle>(0), 55, out), std::nullopt);
+
+    const auto stats = cache.stats();
+    EXPECT_EQ(stats.hits, 1);
+    EXPECT_EQ(stats.misses, 3);
+    EXPECT_EQ(stats.size, 1);
+
+    EXPECT_THROW(LineCache{0}, std::invalid_argument);
+}
+
+TEST(LineCacheTest, Bounded)
+{
+    LineCache cache{32};
+    for (int audience = 0; audience < 1000; ++audience) {
+        cache.insert(
+            PlayHandle{}, audience, std::format("{}"sv, audience),
+            {.amount = audience, .volume_credits = 0});
+        EXPECT_LE(cache.stats().size, 32);
+    }
+
+    // the newest survive
+    std::string out;
+    const auto price = cache.append_to(PlayHandle{}, 999, out);
+    ASSERT_TRUE(price);
+    EXPECT_EQ(price->amount, 999);
+    EXPECT_EQ(out, "999"s);
+    EXPECT_EQ(cache.append_to(PlayHandle{}, 0, out), std::nullopt);
+}
+
+TEST(LineCacheTest, Statements)
+{
+    const PlayCatalog plays{{
+        {"hamlet"s, {.name = "Hamlet"s, .type = Play::Type::Tragedy}},
+        {"as-like"s, {.name = "As You Like It"s, .type = Play::Type::Comedy}},
+        {"othello"s, {.name = "Othello"s, .type = Play::Type::Tragedy}},
+    }};
+    const std::array play_ids{"hamlet"s, "as-like"s, "othello"s};
+
+    std::vector<Invoice> invoices(1000);
+    for (int i = 0; auto& invoice : invoices) {
+        invoice.customer = std::format("Customer #{}"sv, i);
+        for (int j = 0; j < i % 7; ++j) {
+            invoice.performances.push_back({.play_id = play_ids[(i + j) % 3], .audience = i * j % 50});
+        }
+        ++i;
+    }
+
+    std::string expected_text;
+    statements(invoices, plays, expected_text);
+
+    const auto num_lines = std::transform_reduce(
+        std::cbegin(invoices), std::cend(invoices), std::size_t{0},
+        std::plus{}, [](const auto& invoice) { return std::size(invoice.performances); });
+    std::set<std::pair<std::string, int>> keys;
+    for (const auto& invoice : invoices) {
+        for (const auto& perf : invoice.performances) { keys.emplace(perf.play_id, perf.audience); }
+    }
+    // holding every line even if all of them fall into one of the 16 shards
+    // so that nothing is evicted and the counts are exact
+    constexpr std::size_t capacity = 10'000;
+    ASSERT_LE(std::size(keys), capacity / 16);
+
+    LineCache cache{capacity};
+    std::string actual_text;
+    statements(invoices, plays, cache, actual_text);
+    EXPECT_EQ(actual_text, expected_text);
+    auto stats = cache.stats();
+    EXPECT_EQ(stats.misses, std::size(keys));
+    EXPECT_EQ(stats.hits, num_lines - std::size(keys));
+    EXPECT_EQ(stats.size, std::size(keys));
+
+    // all hits once cached
+    actual_text.clear();
+    statements(std::execution::par, invoices, plays, cache, actual_text);
+    EXPECT_EQ(actual_text, expected_text);
+    stats = cache.stats();
+    EXPECT_EQ(stats.misses, std::size(keys));
+    EXPECT_EQ(stats.hits, 2 * num_lines - std::size(keys));
+    EXPECT_EQ(stats.size, std::size(keys));
+}
+
+TEST(LineCacheTest, Overflow)
+{
+    const PlayCatalog plays{{{"hamlet"s, {.name = "Hamlet"s, .type = Play::Type::Tragedy}}}};
+    std::vector<Invoice> invoices{
+        {.customer = "BigCo"s, .performances = {{.play_id = "hamlet"s, .audience = 55}}},
+        {.customer = "HugeCo"s, .performances = {}},
+    };
+    // the later invoice split among the tasks rendering in parallel,
+    // whose total overflows only once the subtotals of all its parts are added up
+    invoices[1].performances.assign(100, {.play_id = "hamlet"s, .audience = 1});
+
+    LineCache cache{100};
+    cache.insert(
+        plays.handle_for(invoices[1].performances[0]), 1, "  Hamlet: (priceless)\n"sv,
+        {.amount = std::numeric_limits<std::int64_t>::max() / 50, .volume_credits = 0});
+
+    std::string out;
+    EXPECT_THROW(statements(invoices, plays, cache, out), std::overflow_error);
+
+    // leaving `out` intact in parallel
+    out = "(previous batch)\n"s;
+    EXPECT_THROW(statements(std::execution::par, invoices, plays, cache, out), std::overflow_error);
+    EXPECT_EQ(out, "(previous batch)\n"s);
+}
+
+TEST(LineCacheTest, OverflowBeforeError)
+{
+    const PlayCatalog plays{{{"hamlet"s, {.name = "Hamlet"s, .type = Play::Type::Tragedy}}}};
+    std::vector<Invoice> invoices{
+        {.customer = "HugeCo"s, .performances = {}},
+        {.customer = "BadCo"s, .performances = {{.play_id = "unknown"s, .audience = 1}}},
+    };
+    // the split invoice overflowing comes before the invoice with an unknown play,
+    // so its overflow is reported as the sequential rendering would
+    invoices[0].performances.assign(100, {.play_id = "hamlet"s, .audience = 1});
+
+    LineCache cache{100};
+    cache.insert(
+        plays.handle_for(invoices[0].performances[0]), 1, "  Hamlet: (priceless)\n"sv,
+        {.amount = std::numeric_limits<std::int64_t>::max() / 50, .volume_credits = 0});
+
+    std::string out;
+    EXPECT_THROW(statements(invoices, plays, cache, out), std::overflow_error);
+
+    out = "(previous batch)\n"s;
+    EXPECT_THROW(statements(std::execution::par, invoices, plays, cache, out), std::overflow_error);
+    EXPECT_EQ(out, "(previous batch)\n"s);
+}
+
+}
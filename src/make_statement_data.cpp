@@ -0,0 +1,154 @@
+#include "pch.h"
+
+#include "make_statement_data.h"
+
+#include "genre_registry.h"
+#include "play_catalog.h"
+
+namespace {
+
+template<typename Plays>
+StatementData make_statement_data_impl(const Invoice& invoice, const Plays& plays)
+{
+    std::vector<EnrichedPerformance> enriched_performances;
+    enriched_performances.reserve(std::size(invoice.performances));
+    for (const auto& perf : invoice.performances) {
+        enriched_performances.push_back(enrich_performance(perf, play_for(plays, perf)));
+    }
+
+    const auto total_amount = std::accumulate(
+        std::cbegin(enriched_performances), std::cend(enriched_performances),
+        Money{}, [](Money sum, const auto& perf) { return sum + Money{perf.amount}; });
+    const auto total_volume_credits = std::accumulate(
+        std::cbegin(enriched_performances), std::cend(enriched_performances),
+        std::int64_t{0}, [](std::int64_t sum, const auto& perf) { return sum + perf.volume_credits; });
+
+    return {
+        .customer = invoice.customer,
+        .performances = std::move(enriched_performances),
+        .total_amount = total_amount,
+        .total_volume_credits = total_volume_credits
+    };
+}
+
+template<typename Plays>
+StatementData make_statement_data_impl(const Invoice& invoice, const Plays& plays, const GenreRegistry& genres)
+{
+    const auto size = std::size(invoice.performances);
+    std::vector<const Play*> performance_plays;
+    std::vector<Play::Type> play_types;
+    std::vector<int> audiences;
+    performance_plays.reserve(size);
+    play_types.reserve(size);
+    audiences.reserve(size);
+    for (const auto& perf : invoice.performances) {
+        const auto& play = play_for(plays, perf);
+        performance_plays.push_back(&play);
+        play_types.push_back(play.type);
+        audiences.push_back(perf.audience);
+    }
+
+    std::vector<std::int64_t> amounts(size);
+    std::vector<std::int64_t> volume_credits(size);
+    genres.price_performances(play_types, audiences, amounts, volume_credits);
+
+    std::vector<EnrichedPerformance> enriched_performances;
+    enriched_performances.reserve(size);
+    Money total_amount;
+    std::int64_t total_volume_credits = 0;
+    for (std::size_t i = 0; i < size; ++i) {
+        enriched_performances.push_back({
+            .base = invoice.performances[i],
+            .play = *performance_plays[i],
+            .amount = amounts[i],
+            .volume_credits = volume_credits[i]
+        });
+        total_amount += Money{amounts[i]};
+        total_volume_credits += volume_credits[i];
+    }
+
+    return {
+        .customer = invoice.customer,
+        .performances = std::move(enriched_performances),
+        .total_amount = total_amount,
+        .total_volume_credits = total_volume_credits
+    };
+}
+
+// Returns `plays.at(play_id)`; as `std::map<std::string, Play>` admits no heterogeneous lookup
+// (see `PlayCatalog` instead), the key is copied into a string reused by the thread
+// so that looking up line after line allocates nothing once the string is large enough.
+const Play& play_by_id(const std::map<std::string, Play>& plays, std::string_view play_id)
+{
+    thread_local std::string key;
+    key.assign(play_id);
+    return plays.at(key);
+}
+
+}
+
+void throw_unknown_play_id(std::string_view play_id)
+{
+    throw std::out_of_range{std::format("{}: unknown play ID"sv, play_id)};
+}
+
+const Play& play_for(const std::map<std::string, Play>& plays, const Performance& perf)
+{
+    return plays.at(perf.play_id);
+}
+
+const Play& play_for(const PlayCatalog& plays, const Performance& perf)
+{
+    return plays.play_for(perf);
+}
+
+const Play& play_for(const std::map<std::string, Play>& plays, const pmr::Performance& perf)
+{
+    return play_by_id(plays, perf.play_id);
+}
+
+const Play& play_for(const PlayCatalog& plays, const pmr::Performance& perf)
+{
+    return plays.play_for(perf);
+}
+
+const Play& play_for(const std::map<std::string, Play>& plays, const PerformanceView& perf)
+{
+    return play_by_id(plays, perf.play_id);
+}
+
+const Play& play_for(const PlayCatalog& plays, const PerformanceView& perf)
+{
+    return plays.play_for(perf);
+}
+
+EnrichedPerformance enrich_performance(const Performance& perf, const Play& play)
+{
+    return {
+        .base = perf,
+        .play = play,
+        .amount = amount_for(play.type, perf.audience),
+        .volume_credits = volume_credits_for(play.type, perf.audience)
+    };
+}
+
+StatementData make_statement_data(const Invoice& invoice, const std::map<std::string, Play>& plays)
+{
+    return make_statement_data_impl(invoice, plays);
+}
+
+StatementData make_statement_data(const Invoice& invoice, const PlayCatalog& plays)
+{
+    return make_statement_data_impl(invoice, plays);
+}
+
+StatementData make_statement_data(
+    const Invoice& invoice, const std::map<std::string, Play>& plays, const GenreRegistry& genres)
+{
+    return make_statement_data_impl(invoice, plays, genres);
+}
+
+StatementData make_statement_data(const Invoice& invoice, const PlayCatalog& plays, const GenreRegistry& genres)
+{
+    return make_statement_data_impl(invoice, plays, genres);
+}
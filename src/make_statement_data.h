@@ -0,0 +1,78 @@
+#pragma once
+
+#include "money.h"
+#include "pricing_rule.h"
+#include "statement.h"
+
+class GenreRegistry;
+
+struct EnrichedPerformance
+{
+    const Performance& base;
+    const Play& play;
+    std::int64_t amount;
+    std::int64_t volume_credits;
+};
+
+struct StatementData
+{
+    const std::string& customer;
+    std::vector<EnrichedPerformance> performances;
+    Money total_amount;
+    std::int64_t total_volume_credits;
+};
+
+// Map of plays from their IDs whose `find` takes `std::string_view` (heterogeneous lookup),
+// e.g., `PlayHashMap` or `std::map<std::string, Play, std::less<>>`
+template<typename Plays>
+concept HeterogeneousPlayMap = requires(const Plays& plays, std::string_view play_id)
+{
+    { plays.find(play_id) == std::cend(plays) } -> std::convertible_to<bool>;
+    { plays.find(play_id)->second } -> std::convertible_to<const Play&>;
+};
+
+// Throws `std::out_of_range` reporting that `play_id` is unknown (e.g., "macbeth: unknown play ID").
+[[noreturn]] void throw_unknown_play_id(std::string_view play_id);
+
+// Returns the play for `perf`; throws `std::out_of_range` if not found in `plays`.
+const Play& play_for(const std::map<std::string, Play>& plays, const Performance& perf);
+const Play& play_for(const PlayCatalog& plays, const Performance& perf);
+const Play& play_for(const std::map<std::string, Play>& plays, const pmr::Performance& perf);
+const Play& play_for(const PlayCatalog& plays, const pmr::Performance& perf);
+const Play& play_for(const std::map<std::string, Play>& plays, const PerformanceView& perf);
+const Play& play_for(const PlayCatalog& plays, const PerformanceView& perf);
+
+template<HeterogeneousPlayMap Plays, typename AnyPerformance>
+const Play& play_for(const Plays& plays, const AnyPerformance& perf)
+{
+    const auto it = plays.find(std::string_view{perf.play_id});
+    if (it == std::cend(plays)) { throw_unknown_play_id(perf.play_id); }
+    return it->second;
+}
+
+// Structure looking up plays for performances of `AnyPerformance` by `play_for`,
+// which returns the play or throws `std::out_of_range` if not found,
+// e.g., `PlayCatalog`, `std::map<std::string, Play>`, any `HeterogeneousPlayMap`, or
+// a user-defined one with its own `play_for` (found by argument-dependent lookup)
+template<typename Plays, typename AnyPerformance = Performance>
+concept PlayLookup = requires(const Plays& plays, const AnyPerformance& perf)
+{
+    { play_for(plays, perf) } -> std::same_as<const Play&>;
+};
+
+// Calculates the amount and the volume credits for `perf` of `play`;
+// throws `std::runtime_error` if `play` is of an unknown `Play::Type`.
+EnrichedPerformance enrich_performance(const Performance& perf, const Play& play);
+
+// Calculates everything `statement` renders, without rendering it;
+// the result refers to `invoice` and `plays`, which must outlive it.
+StatementData make_statement_data(const Invoice& invoice, const std::map<std::string, Play>& plays);
+StatementData make_statement_data(const Invoice& invoice, const PlayCatalog& plays);
+
+// Does the same as `make_statement_data` but prices the performances with `genres`,
+// grouping them by genre so that each genre's pricing is called once per invoice,
+// and thus accepts the plays of any genre registered in `genres`;
+// throws `std::runtime_error` for a `Play::Type` not registered.
+StatementData make_statement_data(
+    const Invoice& invoice, const std::map<std::string, Play>& plays, const GenreRegistry& genres);
+StatementData make_statement_data(const Invoice& invoice, const PlayCatalog& plays, const GenreRegistry& genres);
@@ -0,0 +1,80 @@
+#include "pch.h"
+
+#include "make_statement_data.h"
+
+#include "play_catalog.h"
+
+#include <gtest/gtest.h>
+#include <gmock/gmock.h>
+
+using namespace testing;
+
+namespace {
+
+TEST(MakeStatementDataTest, BigCo)
+{
+    const std::map<std::string, Play> plays{
+        {"hamlet"s, {.name = "Hamlet"s, .type = Play::Type::Tragedy}},
+        {"as-like"s, {.name = "As You Like It"s, .type = Play::Type::Comedy}},
+        {"othello"s, {.name = "Othello"s, .type = Play::Type::Tragedy}},
+    };
+
+    const Invoice invoice{
+        .customer = "BigCo"s,
+        .performances = {
+            {
+                .play_id = "hamlet"s,
+                .audience = 55
+            },
+            {
+                .play_id = "as-like"s,
+                .audience = 35
+            },
+            {
+                .play_id = "othello"s,
+                .audience = 40
+            },
+        }
+    };
+
+    const PlayCatalog catalog{plays};
+    for (const auto& data : {make_statement_data(invoice, plays), make_statement_data(invoice, catalog)}) {
+        EXPECT_EQ(&data.customer, &invoice.customer);
+        ASSERT_EQ(std::size(data.performances), 3);
+        EXPECT_EQ(&data.performances[0].base, &invoice.performances[0]);
+        EXPECT_EQ(data.performances[0].play.name, "Hamlet"s);
+        EXPECT_EQ(data.performances[0].amount, 65000);
+        EXPECT_EQ(data.performances[0].volume_credits, 25);
+        EXPECT_EQ(data.performances[1].play.name, "As You Like It"s);
+        EXPECT_EQ(data.performances[1].amount, 58000);
+        EXPECT_EQ(data.performances[1].volume_credits, 12);
+        EXPECT_EQ(data.performances[2].play.name, "Othello"s);
+        EXPECT_EQ(data.performances[2].amount, 50000);
+        EXPECT_EQ(data.performances[2].volume_credits, 10);
+        EXPECT_EQ(data.total_amount, Money{173000});
+        EXPECT_EQ(data.total_volume_credits, 47);
+    }
+}
+
+TEST(MakeStatementDataTest, UnknownType)
+{
+    const std::map<std::string, Play> plays{
+        {"xyz"s, {.name = "XYZ"s, .type = static_cast<Play::Type>(-1)}},
+    };
+
+    const Invoice invoice{
+        .customer = "UT KK"s,
+        .performances = {
+            {
+                .play_id = "xyz"s,
+                .audience = 10
+            },
+        }
+    };
+
+    EXPECT_THAT(
+        [&] { make_statement_data(invoice, plays); },
+        ThrowsMessage<std::runtime_error>(Eq("-1: unknown Play::Type"s)));
+}
+
+}
@@ -0,0 +1,135 @@
+#include "pch.h"
+
+#include "mapped_file.h"
+
+#if defined(_WIN32)
+#define NOMINMAX
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace {
+
+// Returns the code of the error of the last system call, to be taken before cleaning up
+// (e.g., closing a handle), which may overwrite it.
+int last_error() noexcept
+{
+#if defined(_WIN32)
+    return static_cast<int>(::GetLastError());
+#else
+    return errno;
+#endif
+}
+
+[[noreturn]] void throw_error(const std::filesystem::path& path, const char* what, int error)
+{
+#if defined(_WIN32)
+    const std::error_code ec{error, std::system_category()};
+#else
+    const std::error_code ec{error, std::generic_category()};
+#endif
+    throw std::system_error{ec, std::format("{}: {}"sv, path.string(), what)};
+}
+
+}
+
+#if defined(_WIN32)
+
+MappedFile::MappedFile(const std::filesystem::path& path)
+{
+    const auto file = ::CreateFileW(
+        path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (file == INVALID_HANDLE_VALUE) { throw_error(path, "CreateFileW", last_error()); }
+
+    LARGE_INTEGER size;
+    if (!::GetFileSizeEx(file, &size)) {
+        const auto error = last_error();
+        ::CloseHandle(file);
+        throw_error(path, "GetFileSizeEx", error);
+    }
+    if (size.QuadPart == 0) {
+        // an empty file cannot be mapped
+        ::CloseHandle(file);
+        return;
+    }
+
+    const auto mapping = ::CreateFileMappingW(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    auto error = last_error();
+    ::CloseHandle(file);
+    if (!mapping) { throw_error(path, "CreateFileMappingW", error); }
+
+    const auto view = ::MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+    error = last_error();
+    ::CloseHandle(mapping);
+    if (!view) { throw_error(path, "MapViewOfFile", error); }
+
+    data_ = static_cast<const std::byte*>(view);
+    size_ = static_cast<std::size_t>(size.QuadPart);
+}
+
+void MappedFile::unmap() noexcept
+{
+    if (data_) { ::UnmapViewOfFile(data_); }
+}
+
+#else
+
+MappedFile::MappedFile(const std::filesystem::path& path)
+{
+    const auto fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) { throw_error(path, "open", last_error()); }
+
+    struct stat st;
+    if (::fstat(fd, &st) < 0) {
+        const auto error = last_error();
+        ::close(fd);
+        throw_error(path, "fstat", error);
+    }
+    if (st.st_size == 0) {
+        // an empty file cannot be mapped
+        ::close(fd);
+        return;
+    }
+
+    const auto size = static_cast<std::size_t>(st.st_size);
+    const auto addr = ::mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    const auto error = last_error();
+    ::close(fd);
+    if (addr == MAP_FAILED) { throw_error(path, "mmap", error); }
+
+    data_ = static_cast<const std::byte*>(addr);
+    size_ = size;
+}
+
+void MappedFile::unmap() noexcept
+{
+    if (data_) { ::munmap(const_cast<std::byte*>(data_), size_); }
+}
+
+#endif
+
+MappedFile::MappedFile(MappedFile&& other) noexcept :
+    data_{std::exchange(other.data_, nullptr)},
+    size_{std::exchange(other.size_, 0)}
+{
+}
+
+MappedFile& MappedFile::operator=(MappedFile&& other) noexcept
+{
+    if (this != &other) {
+        unmap();
+        data_ = std::exchange(other.data_, nullptr);
+        size_ = std::exchange(other.size_, 0);
+    }
+    return *this;
+}
+
+MappedFile::~MappedFile()
+{
+    unmap();
+}
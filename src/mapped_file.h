@@ -0,0 +1,20 @@
+#pragma once
+
+// Read-only memory mapping of a whole file
+class MappedFile
+{
+public:
+    // Maps the file at `path`; throws `std::system_error` on failure.
+    explicit MappedFile(const std::filesystem::path& path);
+    MappedFile(MappedFile&& other) noexcept;
+    MappedFile& operator=(MappedFile&& other) noexcept;
+    ~MappedFile();
+
+    std::span<const std::byte> bytes() const noexcept { return {data_, size_}; }
+
+private:
+    void unmap() noexcept;
+
+    const std::byte* data_ = nullptr;
+    std::size_t size_ = 0;
+};
@@ -0,0 +1,42 @@
+#include "pch.h"
+
+#include "mapped_file.h"
+
+#include <gtest/gtest.h>
+#include <gmock/gmock.h>
+
+using namespace testing;
+
+namespace {
+
+std::string_view as_string_view(std::span<const std::byte> bytes)
+{
+    return {reinterpret_cast<const char*>(std::data(bytes)), std::size(bytes)};
+}
+
+TEST(MappedFileTest, Map)
+{
+    const auto path = std::filesystem::temp_directory_path() / "mapped_file_test.txt";
+    const auto expected_text = "some text\nand more\n"s;
+    {
+        std::ofstream ofs{path, std::ios_base::binary};
+        ofs << expected_text;
+    }
+
+    {
+        MappedFile file{path};
+        EXPECT_EQ(as_string_view(file.bytes()), expected_text);
+
+        const auto moved = std::move(file);
+        EXPECT_EQ(as_string_view(moved.bytes()), expected_text);
+        EXPECT_TRUE(file.bytes().empty());
+    }
+
+    std::ofstream{path, std::ios_base::binary | std::ios_base::trunc}.close();
+    EXPECT_TRUE(MappedFile{path}.bytes().empty());
+
+    std::filesystem::remove(path);
+    EXPECT_THROW(MappedFile{path}, std::system_error);
+}
+
+}
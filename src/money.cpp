@@ -0,0 +1,189 @@
+#include "pch.h"
+
+#include "money.h"
+
+namespace {
+
+constexpr std::size_t max_digits = std::numeric_limits<std::uint64_t>::digits10 + 1;
+
+// Returns the size of the `i`-th digit group (counted from the right) or
+// zero if the digits are no longer to be grouped
+std::size_t group_size(const std::string& grouping, std::size_t i)
+{
+    if (grouping.empty()) { return 0; }
+    const auto size = grouping[std::min(i, grouping.size() - 1)];
+    return (size <= 0 || size == CHAR_MAX) ? 0 : static_cast<std::size_t>(size);
+}
+
+}
+
+Money checked(Money amount)
+{
+    if (amount.saturated()) { throw std::overflow_error{"amount of money out of range"s}; }
+    return amount;
+}
+
+std::to_chars_result usd_to_chars(char* first, char* last, std::int64_t cents) noexcept
+{
+    const auto magnitude = cents < 0 ?
+        0 - static_cast<std::uint64_t>(cents) : static_cast<std::uint64_t>(cents);
+    std::array<char, max_digits> digit_buffer;
+    const auto digits_end = std::to_chars(
+        std::begin(digit_buffer), std::end(digit_buffer), magnitude / 100).ptr;
+    const auto num_digits = static_cast<std::size_t>(digits_end - std::begin(digit_buffer));
+
+    // sign, "$", the dollars with a comma every three digits, and ".", followed by two digits
+    const auto size = (cents < 0) + 1 + num_digits + (num_digits - 1) / 3 + 3;
+    if (std::cmp_less(last - first, size)) { return {last, std::errc::value_too_large}; }
+
+    auto out = first;
+    if (cents < 0) { *out++ = '-'; }
+    *out++ = '$';
+    for (std::size_t i = 0; i < num_digits; ++i) {
+        if (i > 0 && (num_digits - i) % 3 == 0) { *out++ = ','; }
+        *out++ = digit_buffer[i];
+    }
+    const auto fraction = magnitude % 100;
+    *out++ = '.';
+    *out++ = static_cast<char>('0' + fraction / 10);
+    *out++ = static_cast<char>('0' + fraction % 10);
+    return {out, std::errc{}};
+}
+
+MoneyFormatter::MoneyFormatter(const std::locale& loc)
+{
+    const auto& punct = std::use_facet<std::moneypunct<char>>(loc);
+    symbol_ = punct.curr_symbol();
+    positive_sign_ = punct.positive_sign();
+    negative_sign_ = punct.negative_sign();
+    grouping_ = punct.grouping();
+    pos_format_ = punct.pos_format();
+    neg_format_ = punct.neg_format();
+    frac_digits_ = std::max(punct.frac_digits(), 0);
+    decimal_point_ = punct.decimal_point();
+    thousands_sep_ = punct.thousands_sep();
+}
+
+std::size_t MoneyFormatter::max_size() const noexcept
+{
+    // symbol, sign, space, and the digits (possibly padded with zeros and
+    // interleaved with thousands separators) together with a decimal point
+    return std::size(symbol_) + std::max(std::size(positive_sign_), std::size(negative_sign_)) + 1
+        + 2 * std::max(max_digits, static_cast<std::size_t>(frac_digits_) + 1) + 1;
+}
+
+std::to_chars_result MoneyFormatter::to_chars(char* first, char* last, std::int64_t units) const noexcept
+{
+    std::array<char, max_digits> digit_buffer;
+    const auto magnitude = units < 0 ?
+        0 - static_cast<std::uint64_t>(units) : static_cast<std::uint64_t>(units);
+    const auto digits_end = std::to_chars(
+        std::begin(digit_buffer), std::end(digit_buffer), magnitude).ptr;
+    const std::string_view digits{std::begin(digit_buffer), digits_end};
+
+    const auto frac_digits = static_cast<std::size_t>(frac_digits_);
+    const auto int_digits = std::size(digits) > frac_digits ? std::size(digits) - frac_digits : 0;
+
+    auto out = first;
+    bool overflow = false;
+    auto put = [&](std::string_view chars)
+    {
+        if (overflow || std::cmp_less(last - out, std::size(chars))) {
+            overflow = true;
+            return;
+        }
+        out = std::ranges::copy(chars, out).out;
+    };
+
+    auto put_value = [&]
+    {
+        if (int_digits == 0) {
+            put("0"sv);
+        }
+        else {
+            // group the integral digits from the right
+            std::array<char, 2 * max_digits> grouped;
+            auto p = std::end(grouped);
+            std::size_t group = 0;
+            std::size_t left = group_size(grouping_, group);
+            for (auto i = int_digits; i > 0; --i) {
+                if (left == 0 && group_size(grouping_, group) != 0) {
+                    *--p = thousands_sep_;
+                    left = group_size(grouping_, ++group);
+                }
+                *--p = digits[i - 1];
+                if (left > 0) { --left; }
+            }
+            put({p, std::end(grouped)});
+        }
+
+        if (frac_digits > 0) {
+            put({&decimal_point_, 1});
+            for (auto i = std::size(digits); i < frac_digits; ++i) { put("0"sv); }
+            put(digits.substr(int_digits));
+        }
+    };
+
+    const std::string_view sign = units < 0 ? negative_sign_ : positive_sign_;
+    const auto& format = units < 0 ? neg_format_ : pos_format_;
+    for (const auto part : format.field) {
+        switch (part) {
+        case std::money_base::none:
+            break;
+        case std::money_base::space:
+            put(" "sv);
+            break;
+        case std::money_base::symbol:
+            put(symbol_);
+            break;
+        case std::money_base::sign:
+            put(sign.substr(0, 1));
+            break;
+        case std::money_base::value:
+            put_value();
+            break;
+        }
+    }
+    // the rest of a multi-character sign goes after everything else, e.g., "($1.00)"
+    if (std::size(sign) > 1) { put(sign.substr(1)); }
+
+    if (overflow) { return {last, std::errc::value_too_large}; }
+    return {out, std::errc{}};
+}
+
+const MoneyFormatter& money_formatter(const std::locale& loc)
+{
+    using Formatters = std::list<std::pair<std::locale, MoneyFormatter>>;
+    // looked up for every amount formatted, so the last one found is remembered per thread
+    thread_local const Formatters::value_type* last = nullptr;
+    if (last && last->first == loc) { return last->second; }
+
+    // an unnamed locale equals none but its copies, so one built per call would add an entry
+    // every time if cached; only the last one is kept (per thread) instead
+    if (loc.name() == "*"sv) {
+        thread_local std::optional<Formatters::value_type> unnamed;
+        if (!unnamed || unnamed->first != loc) {
+            // not to leave `last` dangling if constructing the formatter throws
+            last = nullptr;
+            unnamed.emplace(loc, MoneyFormatter{loc});
+        }
+        last = &*unnamed;
+        return unnamed->second;
+    }
+
+    static std::shared_mutex mutex;
+    static Formatters formatters;
+    const auto matches = [&](const auto& formatter) { return formatter.first == loc; };
+    {
+        const std::shared_lock lock{mutex};
+        if (const auto it = std::ranges::find_if(formatters, matches); it != std::cend(formatters)) {
+            last = &*it;
+            return it->second;
+        }
+    }
+    const std::lock_guard lock{mutex};
+    auto it = std::ranges::find_if(formatters, matches);
+    if (it == std::end(formatters)) { it = formatters.emplace(std::end(formatters), loc, MoneyFormatter{loc}); }
+    last = &*it;
+    return it->second;
+}
@@ -0,0 +1,109 @@
+#pragma once
+
+// Amount of money in the smallest currency unit (e.g., cents) backed by 64 bits,
+// which sum up any number of `int` amounts (fewer than 2^32 of them) exactly.
+// Adding and subtracting saturate at the limits of the representation instead of overflowing,
+// without branching so that the loops accumulating amounts can still be vectorized;
+// a saturated amount is regarded as overflowed and rejected by `checked`, and stays saturated
+// (at the limit it has reached) whatever added to or subtracted from it afterwards.
+class Money
+{
+public:
+    constexpr Money() noexcept = default;
+    constexpr explicit Money(std::int64_t units) noexcept : units_{units} {}
+
+    constexpr std::int64_t units() const noexcept { return units_; }
+
+    constexpr bool saturated() const noexcept
+    {
+        return units_ == std::numeric_limits<std::int64_t>::max()
+            || units_ == std::numeric_limits<std::int64_t>::min();
+    }
+
+    constexpr Money& operator+=(Money other) noexcept
+    {
+        const auto sum = static_cast<std::int64_t>(
+            static_cast<std::uint64_t>(units_) + static_cast<std::uint64_t>(other.units_));
+        // overflowed if both operands have the same sign, which the sum has not
+        const auto result = ((units_ ^ sum) & (other.units_ ^ sum)) < 0 ? limit(units_) : sum;
+        units_ = saturated() ? units_ : other.saturated() ? other.units_ : result;
+        return *this;
+    }
+
+    constexpr Money& operator-=(Money other) noexcept
+    {
+        const auto difference = static_cast<std::int64_t>(
+            static_cast<std::uint64_t>(units_) - static_cast<std::uint64_t>(other.units_));
+        // overflowed if the operands have different signs and the difference has not the former's
+        const auto result =
+            ((units_ ^ other.units_) & (units_ ^ difference)) < 0 ? limit(units_) : difference;
+        // subtracting a saturated amount saturates at the opposite limit
+        units_ = saturated() ? units_ : other.saturated() ? limit(~other.units_) : result;
+        return *this;
+    }
+
+    friend constexpr Money operator+(Money lhs, Money rhs) noexcept { return lhs += rhs; }
+    friend constexpr Money operator-(Money lhs, Money rhs) noexcept { return lhs -= rhs; }
+
+    friend constexpr auto operator<=>(Money, Money) noexcept = default;
+
+private:
+    // Returns the limit in the direction of the sign of `units`.
+    static constexpr std::int64_t limit(std::int64_t units) noexcept
+    {
+        return (units >> 63) ^ std::numeric_limits<std::int64_t>::max();
+    }
+
+    std::int64_t units_ = 0;
+};
+
+// Returns `amount`; throws `std::overflow_error` if it is saturated.
+Money checked(Money amount);
+
+// Upper bound of the number of characters written by `usd_to_chars`
+// (e.g., "-$92,233,720,368,547,758.08")
+inline constexpr std::size_t usd_max_size = 27;
+
+// Writes `cents` into [`first`, `last`) as USD in the conventions of en_US
+// (e.g., "$1,730.00" and "-$0.05"), byte for byte as `MoneyFormatter` does for en_US.UTF-8,
+// but without any locale (which may not be installed) and faster;
+// follows the conventions of `std::to_chars` on success and failure.
+std::to_chars_result usd_to_chars(char* first, char* last, std::int64_t cents) noexcept;
+
+// Formats amounts of money given in the smallest currency unit (e.g., cents)
+// as `std::put_money` does with `std::showbase` for a given locale,
+// except that amounts less than one currency unit always get a leading zero (e.g., "$0.05"),
+// which some implementations of `std::put_money` omit.
+// Unlike `std::put_money`, all the locale-dependent data is looked up once for all
+// at construction, and `to_chars` writes into a caller-supplied buffer without allocation;
+// once constructed, a formatter can be freely shared among threads.
+class MoneyFormatter
+{
+public:
+    explicit MoneyFormatter(const std::locale& loc);
+
+    // Returns an upper bound of the number of characters written by `to_chars`.
+    std::size_t max_size() const noexcept;
+
+    // Writes `units` into [`first`, `last`),
+    // following the conventions of `std::to_chars` on success and failure.
+    std::to_chars_result to_chars(char* first, char* last, std::int64_t units) const noexcept;
+
+private:
+    std::string symbol_;
+    std::string positive_sign_;
+    std::string negative_sign_;
+    std::string grouping_;
+    std::money_base::pattern pos_format_;
+    std::money_base::pattern neg_format_;
+    int frac_digits_;
+    char decimal_point_;
+    char thousands_sep_;
+};
+
+// Returns the formatter for `loc`; can be called from any thread.
+// The formatter for a named locale is constructed once per name and kept for the rest of
+// the process (as many as the named locales used, which are no more than those installed),
+// whereas that for an unnamed one (e.g., with a facet replaced) is kept only until
+// the same thread asks for a different unnamed locale, which invalidates the reference.
+const MoneyFormatter& money_formatter(const std::locale& loc);
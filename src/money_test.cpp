@@ -0,0 +1,180 @@
+#include "pch.h"
+
+#include "money.h"
+
+#include <gtest/gtest.h>
+#include <gmock/gmock.h>
+
+using namespace testing;
+
+namespace {
+
+// Mimics en_US.UTF-8 so as not to depend on the locales installed
+class UsdPunct final : public std::moneypunct<char>
+{
+protected:
+    char do_decimal_point() const override { return '.'; }
+    char do_thousands_sep() const override { return ','; }
+    std::string do_grouping() const override { return "\3"s; }
+    std::string do_curr_symbol() const override { return "$"s; }
+    std::string do_positive_sign() const override { return ""s; }
+    std::string do_negative_sign() const override { return "-"s; }
+    int do_frac_digits() const override { return 2; }
+    pattern do_pos_format() const override { return {{sign, symbol, value, none}}; }
+    pattern do_neg_format() const override { return {{sign, symbol, value, none}}; }
+};
+
+// Exercises some less common conventions
+class ExoticPunct final : public std::moneypunct<char>
+{
+protected:
+    char do_decimal_point() const override { return ','; }
+    char do_thousands_sep() const override { return '.'; }
+    std::string do_grouping() const override { return "\3\2"s; }
+    std::string do_curr_symbol() const override { return "EUR"s; }
+    std::string do_positive_sign() const override { return ""s; }
+    std::string do_negative_sign() const override { return "()"s; }
+    int do_frac_digits() const override { return 3; }
+    pattern do_pos_format() const override { return {{value, space, symbol, none}}; }
+    pattern do_neg_format() const override { return {{sign, value, space, symbol}}; }
+};
+
+std::string put_money(const std::locale& loc, std::int64_t units)
+{
+    std::ostringstream oss;
+    oss.imbue(loc);
+    oss << std::showbase << std::put_money(static_cast<long double>(units));
+    return std::move(oss).str();
+}
+
+std::string to_chars(const MoneyFormatter& formatter, std::int64_t units)
+{
+    std::string str(formatter.max_size(), '\0');
+    const auto [end, ec] = formatter.to_chars(std::data(str), std::data(str) + std::size(str), units);
+    EXPECT_EQ(ec, std::errc{});
+    str.resize(static_cast<std::size_t>(end - std::data(str)));
+    return str;
+}
+
+// Amounts of at least one currency unit (given 3 or less fractional digits),
+// for which all the standard libraries agree on the output of `std::put_money`
+constexpr std::int64_t test_units[] = {
+    1000, -1000, 1005, 65000, 99999, 100000, 173000, -173000,
+    123456789, 2147483647, -2147483648, 1000000000000, -999999999999999,
+};
+
+TEST(MoneyFormatterTest, Usd)
+{
+    const std::locale loc{std::locale::classic(), new UsdPunct};
+    const MoneyFormatter formatter{loc};
+
+    EXPECT_EQ(to_chars(formatter, 65000), "$650.00"s);
+    EXPECT_EQ(to_chars(formatter, 173000), "$1,730.00"s);
+    EXPECT_EQ(to_chars(formatter, 0), "$0.00"s);
+    EXPECT_EQ(to_chars(formatter, -5), "-$0.05"s);
+    for (const auto units : test_units) {
+        EXPECT_EQ(to_chars(formatter, units), put_money(loc, units)) << units;
+    }
+}
+
+TEST(MoneyFormatterTest, Exotic)
+{
+    const std::locale loc{std::locale::classic(), new ExoticPunct};
+    const MoneyFormatter formatter{loc};
+
+    EXPECT_EQ(to_chars(formatter, 123456789), "1.23.456,789 EUR"s);
+    EXPECT_EQ(to_chars(formatter, -5), "(0,005 EUR)"s);
+    for (const auto units : test_units) {
+        EXPECT_EQ(to_chars(formatter, units), put_money(loc, units)) << units;
+    }
+}
+
+TEST(MoneyFormatterTest, PerLocale)
+{
+    const std::locale loc{std::locale::classic(), new ExoticPunct};
+    const auto& formatter = money_formatter(loc);
+    EXPECT_EQ(to_chars(formatter, 123456789), "1.23.456,789 EUR"s);
+    EXPECT_EQ(&money_formatter(std::locale{loc}), &formatter);
+
+    const std::locale other{std::locale::classic(), new UsdPunct};
+    EXPECT_EQ(to_chars(money_formatter(other), 123456789), "$1,234,567.89"s);
+    EXPECT_EQ(to_chars(money_formatter(loc), 123456789), "1.23.456,789 EUR"s);
+
+    // kept for the named locales, looked up by name
+    const auto& classic = money_formatter(std::locale::classic());
+    EXPECT_EQ(&money_formatter(std::locale{"C"s}), &classic);
+    EXPECT_EQ(to_chars(money_formatter(other), 123456789), "$1,234,567.89"s);
+    EXPECT_EQ(&money_formatter(std::locale::classic()), &classic);
+}
+
+TEST(MoneyFormatterTest, BufferTooSmall)
+{
+    const MoneyFormatter formatter{std::locale{std::locale::classic(), new UsdPunct}};
+
+    std::array<char, 8> buffer;
+    const auto [end, ec] = formatter.to_chars(std::begin(buffer), std::end(buffer), 173000);
+    EXPECT_EQ(ec, std::errc::value_too_large);
+    EXPECT_EQ(end, std::end(buffer));
+}
+
+TEST(MoneyFormatterTest, UsdToChars)
+{
+    const MoneyFormatter formatter{std::locale{std::locale::classic(), new UsdPunct}};
+
+    auto usd = [](std::int64_t cents)
+    {
+        std::array<char, usd_max_size> buffer;
+        const auto [end, ec] = usd_to_chars(std::begin(buffer), std::end(buffer), cents);
+        EXPECT_EQ(ec, std::errc{});
+        return std::string{std::begin(buffer), end};
+    };
+
+    EXPECT_EQ(usd(65000), "$650.00"s);
+    EXPECT_EQ(usd(173000), "$1,730.00"s);
+    EXPECT_EQ(usd(-5), "-$0.05"s);
+    EXPECT_EQ(usd(std::numeric_limits<std::int64_t>::min()), "-$92,233,720,368,547,758.08"s);
+    for (const auto cents : test_units) { EXPECT_EQ(usd(cents), to_chars(formatter, cents)) << cents; }
+    for (std::int64_t cents = -100'000; cents <= 100'000; cents += 7) {
+        EXPECT_EQ(usd(cents), to_chars(formatter, cents)) << cents;
+    }
+
+    std::array<char, 8> buffer;
+    const auto [end, ec] = usd_to_chars(std::begin(buffer), std::end(buffer), 173000);
+    EXPECT_EQ(ec, std::errc::value_too_large);
+    EXPECT_EQ(end, std::end(buffer));
+}
+
+TEST(MoneyTest, Saturating)
+{
+    constexpr auto max = std::numeric_limits<std::int64_t>::max();
+    constexpr auto min = std::numeric_limits<std::int64_t>::min();
+
+    // far beyond `int` but exact
+    EXPECT_EQ(Money{3'000'000'000} + Money{4'000'000'000}, Money{7'000'000'000});
+    EXPECT_EQ(Money{3'000'000'000} - Money{4'000'000'000}, Money{-1'000'000'000});
+    EXPECT_FALSE((Money{max - 1} + Money{-1}).saturated());
+
+    EXPECT_EQ(Money{max - 1} + Money{2}, Money{max});
+    EXPECT_EQ(Money{min + 1} + Money{-2}, Money{min});
+    EXPECT_EQ(Money{max - 1} - Money{-2}, Money{max});
+    EXPECT_EQ(Money{min + 1} - Money{2}, Money{min});
+    EXPECT_EQ(Money{0} - Money{min}, Money{max});
+    EXPECT_EQ(Money{-1} - Money{min + 1}, Money{max - 1});
+
+    Money total;
+    for (int i = 0; i < 5; ++i) { total += Money{max / 4}; }
+    EXPECT_TRUE(total.saturated());
+    EXPECT_THROW(checked(total), std::overflow_error);
+    EXPECT_EQ(checked(Money{max - 1}), Money{max - 1});
+
+    // saturation is sticky
+    EXPECT_EQ(total - Money{1}, Money{max});
+    EXPECT_EQ(total + Money{min / 2}, Money{max});
+    EXPECT_THROW(checked(total - Money{max / 4}), std::overflow_error);
+    EXPECT_EQ(Money{min} + Money{max}, Money{min});
+    EXPECT_EQ(Money{1} + Money{min}, Money{min});
+    EXPECT_EQ(Money{1} - Money{max}, Money{min});
+    EXPECT_EQ(Money{-1} - Money{min}, Money{max});
+}
+
+}
@@ -5,6 +5,7 @@
 #include <any>
 #include <array>
 #include <atomic>
+#include <bit>
 #include <cassert>
 #include <cctype>
 #include <cerrno>
@@ -15,11 +16,14 @@
 #include <cinttypes>
 #include <climits>
 #include <cmath>
+#include <concepts>
 #include <condition_variable>
+#include <coroutine>
 #include <cstddef>
 #include <cstdint>
 #include <cstdio>
 #include <cstdlib>
+#include <cstring>
 #include <deque>
 #include <exception>
 #include <execution>
@@ -41,6 +45,7 @@
 #include <locale>
 #include <map>
 #include <memory>
+#include <memory_resource>
 #include <mutex>
 #include <new>
 #include <numeric>
@@ -52,6 +57,7 @@
 #include <regex>
 #include <set>
 #include <shared_mutex>
+#include <span>
 #include <sstream>
 #include <stack>
 #include <stdexcept>
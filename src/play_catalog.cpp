@@ -0,0 +1,101 @@
+#include "pch.h"
+
+#include "play_catalog.h"
+
+#include "make_statement_data.h"
+
+PlayCatalog::PlayCatalog(const std::map<std::string, Play>& plays)
+{
+    plays_.reserve(std::size(plays));
+    ids_.reserve(std::size(plays));
+    handles_.reserve(std::size(plays));
+    for (const auto& [play_id, play] : plays) { add(play_id, play); }
+}
+
+std::pair<PlayHandle, bool> PlayCatalog::add(std::string play_id, Play play)
+{
+    const auto handle = static_cast<PlayHandle>(std::size(plays_));
+    if (handle == PlayHandle::unresolved) { throw std::length_error{"too many plays"s}; }
+
+    const auto [it, inserted] = handles_.try_emplace(std::move(play_id), handle);
+    if (inserted) {
+        try {
+            ids_.push_back(it->first);
+            plays_.push_back(std::move(play));
+        }
+        catch (...) {
+            ids_.resize(std::size(plays_));
+            handles_.erase(it);
+            throw;
+        }
+        const auto& added = plays_.back();
+        fingerprint_ = ContentHash{fingerprint_}.add(it->first).add(added.name).add(added.type).digest();
+    }
+    return {it->second, inserted};
+}
+
+std::optional<PlayHandle> PlayCatalog::find(std::string_view play_id) const
+{
+    if (const auto it = handles_.find(play_id); it != std::cend(handles_)) { return it->second; }
+    return std::nullopt;
+}
+
+PlayHandle PlayCatalog::handle_for(const Performance& perf) const
+{
+    return handle_for(perf.play_handle, perf.play_id);
+}
+
+PlayHandle PlayCatalog::handle_for(const pmr::Performance& perf) const
+{
+    return handle_for(perf.play_handle, perf.play_id);
+}
+
+PlayHandle PlayCatalog::handle_for(const PerformanceView& perf) const
+{
+    return handle_for(perf.play_handle, perf.play_id);
+}
+
+const Play* PlayCatalog::find_play(const Performance& perf) const noexcept
+{
+    if (perf.play_handle != PlayHandle::unresolved) {
+        const auto index = static_cast<std::size_t>(perf.play_handle);
+        return index < std::size(plays_) ? &plays_[index] : nullptr;
+    }
+
+    const auto handle = find(perf.play_id);
+    return handle ? &(*this)[*handle] : nullptr;
+}
+
+void PlayCatalog::resolve(Invoice& invoice) const
+{
+    resolve_impl(invoice);
+}
+
+void PlayCatalog::resolve(pmr::Invoice& invoice) const
+{
+    resolve_impl(invoice);
+}
+
+PlayHandle PlayCatalog::handle_for(PlayHandle handle, std::string_view play_id) const
+{
+    if (handle != PlayHandle::unresolved) {
+        if (static_cast<std::size_t>(handle) >= std::size(plays_)) {
+            throw std::out_of_range{"invalid play handle"s};
+        }
+        return handle;
+    }
+
+    const auto found = find(play_id);
+    if (!found) { throw_unknown_play_id(play_id); }
+    return *found;
+}
+
+template<typename AnyInvoice>
+void PlayCatalog::resolve_impl(AnyInvoice& invoice) const
+{
+    for (auto& perf : invoice.performances) {
+        const auto handle = find(perf.play_id);
+        if (!handle) { throw_unknown_play_id(perf.play_id); }
+        perf.play_handle = *handle;
+    }
+}
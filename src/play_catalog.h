@@ -0,0 +1,71 @@
+#pragma once
+
+#include "content_hash.h"
+#include "statement.h"
+
+// Catalog of plays that interns play IDs into dense `PlayHandle`s
+// so that the play for a performance carrying a handle is found by a flat array index
+// rather than by a lookup keyed by the play ID.
+class PlayCatalog
+{
+public:
+    PlayCatalog() = default;
+    explicit PlayCatalog(const std::map<std::string, Play>& plays);
+
+    // Adds `play` with `play_id` unless the ID is already cataloged;
+    // returns the handle to the play with `play_id` and whether `play` has been added.
+    std::pair<PlayHandle, bool> add(std::string play_id, Play play);
+
+    // Returns the handle to the play with `play_id` if cataloged.
+    std::optional<PlayHandle> find(std::string_view play_id) const;
+
+    const Play& operator[](PlayHandle handle) const noexcept
+    {
+        assert(static_cast<std::size_t>(handle) < std::size(plays_));
+        return plays_[static_cast<std::size_t>(handle)];
+    }
+
+    // Returns the ID of the play with `handle`.
+    const std::string& id(PlayHandle handle) const noexcept
+    {
+        assert(static_cast<std::size_t>(handle) < std::size(ids_));
+        return ids_[static_cast<std::size_t>(handle)];
+    }
+
+    // Returns the handle to the play for `perf`, which is its own handle if resolved or
+    // the one found by its ID otherwise; throws `std::out_of_range` if no such play is cataloged.
+    PlayHandle handle_for(const Performance& perf) const;
+    PlayHandle handle_for(const pmr::Performance& perf) const;
+    PlayHandle handle_for(const PerformanceView& perf) const;
+
+    // Returns the play for `perf`, i.e., `(*this)[handle_for(perf)]`.
+    const Play& play_for(const Performance& perf) const { return (*this)[handle_for(perf)]; }
+    const Play& play_for(const pmr::Performance& perf) const { return (*this)[handle_for(perf)]; }
+    const Play& play_for(const PerformanceView& perf) const { return (*this)[handle_for(perf)]; }
+
+    // Returns the play for `perf` if cataloged (or the handle of `perf` is valid) or null otherwise.
+    const Play* find_play(const Performance& perf) const noexcept;
+
+    // Resolves the play handles of all the performances in `invoice`;
+    // throws `std::out_of_range` (leaving `invoice` partially resolved) if any play is not cataloged.
+    void resolve(Invoice& invoice) const;
+    void resolve(pmr::Invoice& invoice) const;
+
+    std::size_t size() const noexcept { return std::size(plays_); }
+
+    // Returns the hash of the plays cataloged so far (in the order added), kept up by `add`,
+    // which tells apart the versions of a catalog for no more than reading it
+    // (and is the same for catalogs of the same plays, even across runs).
+    std::uint64_t fingerprint() const noexcept { return fingerprint_; }
+
+private:
+    PlayHandle handle_for(PlayHandle handle, std::string_view play_id) const;
+
+    template<typename AnyInvoice>
+    void resolve_impl(AnyInvoice& invoice) const;
+
+    std::vector<Play> plays_;
+    std::vector<std::string> ids_;
+    std::unordered_map<std::string, PlayHandle, StringHash, std::equal_to<>> handles_;
+    std::uint64_t fingerprint_ = ContentHash{}.digest();
+};
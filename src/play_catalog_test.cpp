@@ -0,0 +1,202 @@
+#include "pch.h"
+
+#include "play_catalog.h"
+
+#include <gtest/gtest.h>
+#include <gmock/gmock.h>
+
+using namespace testing;
+
+namespace {
+
+const std::map<std::string, Play> plays{
+    {"hamlet"s, {.name = "Hamlet"s, .type = Play::Type::Tragedy}},
+    {"as-like"s, {.name = "As You Like It"s, .type = Play::Type::Comedy}},
+    {"othello"s, {.name = "Othello"s, .type = Play::Type::Tragedy}},
+};
+
+TEST(PlayCatalogTest, Add)
+{
+    PlayCatalog catalog;
+
+    const auto [hamlet, hamlet_added] = catalog.add("hamlet"s, {.name = "Hamlet"s, .type = Play::Type::Tragedy});
+    const auto [as_like, as_like_added] = catalog.add("as-like"s, {.name = "As You Like It"s, .type = Play::Type::Comedy});
+    const auto [again, again_added] = catalog.add("hamlet"s, {.name = "Hamlet II"s, .type = Play::Type::Comedy});
+
+    EXPECT_TRUE(hamlet_added);
+    EXPECT_TRUE(as_like_added);
+    EXPECT_FALSE(again_added);
+    EXPECT_EQ(static_cast<std::size_t>(hamlet), 0);
+    EXPECT_EQ(static_cast<std::size_t>(as_like), 1);
+    EXPECT_EQ(again, hamlet);
+    EXPECT_EQ(catalog.size(), 2);
+    EXPECT_EQ(catalog[hamlet].name, "Hamlet"s);
+    EXPECT_EQ(catalog[as_like].name, "As You Like It"s);
+    EXPECT_EQ(catalog.id(hamlet), "hamlet"s);
+    EXPECT_EQ(catalog.id(as_like), "as-like"s);
+}
+
+TEST(PlayCatalogTest, Find)
+{
+    const PlayCatalog catalog{plays};
+
+    EXPECT_EQ(catalog.size(), std::size(plays));
+    for (const auto& [play_id, play] : plays) {
+        const auto handle = catalog.find(play_id);
+        ASSERT_TRUE(handle);
+        EXPECT_EQ(catalog[*handle].name, play.name);
+    }
+    EXPECT_FALSE(catalog.find("macbeth"sv));
+}
+
+TEST(PlayCatalogTest, Resolve)
+{
+    const PlayCatalog catalog{plays};
+
+    Invoice invoice{
+        .customer = "BigCo"s,
+        .performances = {
+            {
+                .play_id = "hamlet"s,
+                .audience = 55
+            },
+            {
+                .play_id = "as-like"s,
+                .audience = 35
+            },
+        }
+    };
+
+    EXPECT_EQ(catalog.play_for(invoice.performances[1]).name, "As You Like It"s);
+
+    catalog.resolve(invoice);
+    for (const auto& perf : invoice.performances) {
+        EXPECT_EQ(perf.play_handle, catalog.find(perf.play_id));
+        EXPECT_EQ(&catalog.play_for(perf), &catalog[perf.play_handle]);
+    }
+
+    invoice.performances.push_back({.play_id = "macbeth"s, .audience = 10});
+    EXPECT_THAT(
+        [&] { catalog.resolve(invoice); },
+        ThrowsMessage<std::out_of_range>(Eq("macbeth: unknown play ID"s)));
+    EXPECT_THROW(catalog.play_for(invoice.performances.back()), std::out_of_range);
+}
+
+TEST(PlayCatalogTest, ResolvePmr)
+{
+    const PlayCatalog catalog{plays};
+
+    std::pmr::monotonic_buffer_resource arena;
+    pmr::Invoice invoice{"BigCo"sv, &arena};
+    invoice.performances.emplace_back("hamlet"sv, 55);
+    invoice.performances.emplace_back("as-like"sv, 35);
+
+    const auto expected_text = statement(invoice, plays);
+
+    catalog.resolve(invoice);
+    for (const auto& perf : invoice.performances) {
+        EXPECT_EQ(perf.play_handle, catalog.find(perf.play_id));
+        EXPECT_EQ(perf.play_id.get_allocator().resource(), &arena);
+    }
+    EXPECT_EQ(statement(invoice, catalog), expected_text);
+
+    invoice.performances.emplace_back("macbeth"sv, 10);
+    EXPECT_THAT(
+        [&] { catalog.resolve(invoice); },
+        ThrowsMessage<std::out_of_range>(Eq("macbeth: unknown play ID"s)));
+}
+
+TEST(PlayCatalogTest, View)
+{
+    const PlayCatalog catalog{plays};
+
+    // the IDs are looked up right in the buffer
+    const auto buffer = "BigCo|hamlet|as-like|macbeth"s;
+    const std::string_view view{buffer};
+    const std::array performances{
+        PerformanceView{.play_id = view.substr(6, 6), .audience = 55},
+        PerformanceView{
+            .play_id = view.substr(13, 7), .audience = 35, .play_handle = *catalog.find("as-like"sv)
+        },
+    };
+    const InvoiceView invoice{.customer = view.substr(0, 5), .performances = performances};
+
+    EXPECT_EQ(catalog.handle_for(performances[0]), catalog.find("hamlet"sv));
+    EXPECT_EQ(&catalog.play_for(performances[1]), &catalog[*catalog.find("as-like"sv)]);
+    EXPECT_EQ(statement(invoice, catalog), statement(invoice, plays));
+
+    EXPECT_THAT(
+        [&] { catalog.handle_for(PerformanceView{.play_id = view.substr(21), .audience = 10}); },
+        ThrowsMessage<std::out_of_range>(Eq("macbeth: unknown play ID"s)));
+}
+
+TEST(PlayCatalogTest, StatementsWithErrors)
+{
+    const PlayCatalog catalog{plays};
+
+    std::vector<Invoice> invoices{
+        {
+            .customer = "BigCo"s,
+            .performances = {
+                {
+                    .play_id = "hamlet"s,
+                    .audience = 55
+                },
+            }
+        },
+        {
+            .customer = "BadCo"s,
+            .performances = {
+                {
+                    .play_id = "macbeth"s,
+                    .audience = 10
+                },
+            }
+        },
+    };
+    catalog.resolve(invoices[0]);
+    invoices.push_back(invoices[0]);
+    invoices.back().performances[0].play_handle = static_cast<PlayHandle>(catalog.size());
+
+    std::string actual_text;
+    std::vector<StatementError> errors;
+    statements(invoices, catalog, actual_text, errors);
+
+    EXPECT_EQ(actual_text, statement(invoices[0], plays));
+    ASSERT_EQ(std::size(errors), 2);
+    EXPECT_EQ(message(errors[0], invoices), "macbeth: unknown play ID"s);
+    EXPECT_EQ(errors[1].code, StatementError::Code::invalid_play_handle);
+    EXPECT_EQ(errors[1].invoice, 2);
+    EXPECT_EQ(message(errors[1], invoices), "invalid play handle"s);
+}
+
+TEST(PlayCatalogTest, Statement)
+{
+    const PlayCatalog catalog{plays};
+
+    Invoice invoice{
+        .customer = "BigCo"s,
+        .performances = {
+            {
+                .play_id = "hamlet"s,
+                .audience = 55
+            },
+            {
+                .play_id = "as-like"s,
+                .audience = 35
+            },
+            {
+                .play_id = "othello"s,
+                .audience = 40
+            },
+        }
+    };
+
+    const auto expected_text = statement(invoice, plays);
+
+    EXPECT_EQ(statement(invoice, catalog), expected_text);
+    catalog.resolve(invoice);
+    EXPECT_EQ(statement(invoice, catalog), expected_text);
+}
+
+}
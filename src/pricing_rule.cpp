@@ -0,0 +1,10 @@
+#include "pch.h"
+
+#include "pricing_rule.h"
+
+void throw_unknown_type(Play::Type type)
+{
+    throw std::runtime_error{std::format(
+        "{}: unknown Play::Type"sv,
+        static_cast<std::underlying_type_t<Play::Type>>(type))};
+}
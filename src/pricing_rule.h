@@ -0,0 +1,100 @@
+#pragma once
+
+#include "statement.h"
+
+// Pricing rule for plays of `type`, specialized for each known `Play::Type`
+// so that the rule for any other type does not even compile;
+// the formulas are free of branches so that compilers can inline and vectorize them,
+// and are evaluated in 64 bits not to overflow for any `int` audience.
+template<Play::Type type>
+struct PricingRule;
+
+template<>
+struct PricingRule<Play::Type::Tragedy>
+{
+    static constexpr std::int64_t amount(int audience) noexcept
+    {
+        return 40000 + 1000 * std::max(std::int64_t{audience} - 30, std::int64_t{0});
+    }
+
+    static constexpr std::int64_t volume_credits(int audience) noexcept
+    {
+        return std::max(std::int64_t{audience} - 30, std::int64_t{0});
+    }
+};
+
+template<>
+struct PricingRule<Play::Type::Comedy>
+{
+    static constexpr std::int64_t amount(int audience) noexcept
+    {
+        const std::int64_t seats = audience;
+        return 30000 + 10000 * (seats > 20) + 500 * std::max(seats - 20, std::int64_t{0}) + 300 * seats;
+    }
+
+    static constexpr std::int64_t volume_credits(int audience) noexcept
+    {
+        // add extra credit for every ten comedy attendees
+        const std::int64_t seats = audience;
+        return std::max(seats - 30, std::int64_t{0}) + seats / 5;
+    }
+};
+
+template<Play::Type... types>
+struct PlayTypeList
+{
+    // Calls `f(std::integral_constant<Play::Type, type>{})` for each of `types`.
+    template<typename F>
+    static constexpr void for_each(F&& f)
+    {
+        (f(std::integral_constant<Play::Type, types>{}), ...);
+    }
+
+    static constexpr bool contains(Play::Type type) noexcept { return ((type == types) || ...); }
+};
+
+// All the `Play::Type`s with a `PricingRule`; a new genre is added here along with its rule.
+using KnownPlayTypes = PlayTypeList<Play::Type::Tragedy, Play::Type::Comedy>;
+
+// Throws `std::runtime_error` reporting that `type` is an unknown `Play::Type`.
+[[noreturn]] void throw_unknown_type(Play::Type type);
+
+template<typename F, Play::Type first, Play::Type... rest>
+auto visit_play_type(Play::Type type, F&& f, PlayTypeList<first, rest...>)
+    -> std::invoke_result_t<F&, std::integral_constant<Play::Type, first>>
+{
+    if (type == first) { return f(std::integral_constant<Play::Type, first>{}); }
+    if constexpr (sizeof...(rest) > 0) {
+        return visit_play_type(type, f, PlayTypeList<rest...>{});
+    }
+    else {
+        throw_unknown_type(type);
+    }
+}
+
+// Calls `f(std::integral_constant<Play::Type, type>{})` for the `type` known only at runtime
+// so that `f` can be specialized for each type;
+// throws `std::runtime_error` if `type` is not in `KnownPlayTypes`.
+template<typename F>
+decltype(auto) visit_play_type(Play::Type type, F&& f)
+{
+    return visit_play_type(type, f, KnownPlayTypes{});
+}
+
+// Calculate the amount and the volume credits for a performance of a play of `type`
+// with `audience`; throw `std::runtime_error` for an unknown `Play::Type`.
+inline std::int64_t amount_for(Play::Type type, int audience)
+{
+    return visit_play_type(type, [=](auto t)
+    {
+        return PricingRule<decltype(t)::value>::amount(audience);
+    });
+}
+
+inline std::int64_t volume_credits_for(Play::Type type, int audience)
+{
+    return visit_play_type(type, [=](auto t)
+    {
+        return PricingRule<decltype(t)::value>::volume_credits(audience);
+    });
+}
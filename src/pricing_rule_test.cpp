@@ -0,0 +1,59 @@
+#include "pch.h"
+
+#include "pricing_rule.h"
+
+#include <gtest/gtest.h>
+#include <gmock/gmock.h>
+
+using namespace testing;
+
+namespace {
+
+// the rules are evaluated at compile time
+static_assert(PricingRule<Play::Type::Tragedy>::amount(30) == 40000);
+static_assert(PricingRule<Play::Type::Tragedy>::amount(55) == 65000);
+static_assert(PricingRule<Play::Type::Tragedy>::volume_credits(55) == 25);
+static_assert(PricingRule<Play::Type::Comedy>::amount(20) == 36000);
+static_assert(PricingRule<Play::Type::Comedy>::amount(35) == 58000);
+static_assert(PricingRule<Play::Type::Comedy>::volume_credits(35) == 12);
+
+// without overflowing (which would not be a constant expression) for any audience
+constexpr auto max_audience = std::numeric_limits<int>::max();
+static_assert(PricingRule<Play::Type::Tragedy>::amount(max_audience) == 2'147'483'657'000);
+static_assert(PricingRule<Play::Type::Tragedy>::volume_credits(max_audience) == 2'147'483'617);
+static_assert(PricingRule<Play::Type::Comedy>::amount(max_audience) == 1'717'986'947'600);
+static_assert(PricingRule<Play::Type::Comedy>::volume_credits(max_audience) == 2'576'980'346);
+
+static_assert(KnownPlayTypes::contains(Play::Type::Tragedy));
+static_assert(KnownPlayTypes::contains(Play::Type::Comedy));
+static_assert(!KnownPlayTypes::contains(static_cast<Play::Type>(-1)));
+
+template<Play::Type type>
+concept HasPricingRule = requires { PricingRule<type>::amount(0); };
+
+static_assert(HasPricingRule<Play::Type::Comedy>);
+static_assert(!HasPricingRule<static_cast<Play::Type>(-1)>);
+
+TEST(PricingRuleTest, VisitPlayType)
+{
+    for (const auto type : {Play::Type::Tragedy, Play::Type::Comedy}) {
+        EXPECT_EQ(visit_play_type(type, [](auto t) { return decltype(t)::value; }), type);
+    }
+
+    EXPECT_EQ(amount_for(Play::Type::Tragedy, 55), 65000);
+    EXPECT_EQ(volume_credits_for(Play::Type::Tragedy, 55), 25);
+    EXPECT_EQ(amount_for(Play::Type::Comedy, 35), 58000);
+    EXPECT_EQ(volume_credits_for(Play::Type::Comedy, 35), 12);
+}
+
+TEST(PricingRuleTest, UnknownType)
+{
+    EXPECT_THAT(
+        [] { amount_for(static_cast<Play::Type>(-1), 10); },
+        ThrowsMessage<std::runtime_error>(Eq("-1: unknown Play::Type"s)));
+    EXPECT_THAT(
+        [] { volume_credits_for(static_cast<Play::Type>(2), 10); },
+        ThrowsMessage<std::runtime_error>(Eq("2: unknown Play::Type"s)));
+}
+
+}
@@ -0,0 +1,325 @@
+#pragma once
+
+#include "instrumentation.h"
+#include "make_statement_data.h"
+#include "money.h"
+
+// Building blocks of the plain-text statement, shared by all the representations of
+// invoices and plays that `statement` accepts
+
+// Amount of money in cents, formatted by `std::format` and the like
+// as USD in en_US.UTF-8 (e.g., "$1,730.00") in place without allocation,
+// by `usd_to_chars` without any locale or, with the `L` option (e.g., "{:L}"),
+// by `money_formatter` as the locale of the formatting formats it
+// (e.g., `std::format(loc, "{:L}"sv, usd)`, otherwise the global locale),
+// in the currency of that locale
+struct Usd
+{
+    std::int64_t cents;
+};
+
+template<>
+struct std::formatter<Usd>
+{
+    // the only format spec supported is `L`
+    constexpr auto parse(std::format_parse_context& ctx)
+    {
+        auto it = ctx.begin();
+        if (it != ctx.end() && *it == 'L') {
+            by_locale = true;
+            ++it;
+        }
+        if (it != ctx.end() && *it != '}') { throw std::format_error{"invalid format spec for Usd"}; }
+        return it;
+    }
+
+    template<typename FormatContext>
+    auto format(const Usd& usd, FormatContext& ctx) const
+    {
+        std::array<char, 64> buffer;
+        if (!by_locale) {
+            const auto end = usd_to_chars(std::data(buffer), std::data(buffer) + usd_max_size, usd.cents).ptr;
+            return std::copy(std::data(buffer), end, ctx.out());
+        }
+
+        // on the heap only if the currency of the locale may not fit in the buffer
+        // (e.g., with a long symbol)
+        const auto& formatter = money_formatter(ctx.locale());
+        std::string large_buffer;
+        std::span<char> chars{buffer};
+        if (formatter.max_size() > std::size(buffer)) {
+            large_buffer.resize(formatter.max_size());
+            chars = large_buffer;
+        }
+        const auto [end, ec] = formatter.to_chars(std::data(chars), std::data(chars) + std::size(chars), usd.cents);
+        if (ec != std::errc{}) { throw std::format_error{"cannot format Usd by the locale"}; }
+        return std::copy(std::data(chars), end, ctx.out());
+    }
+
+    bool by_locale = false;
+};
+
+// Returns an estimate of the size of the statement for `invoice`, without looking up its plays,
+// to reserve the output at once.
+template<typename AnyInvoice>
+std::size_t estimated_statement_size(const AnyInvoice& invoice) noexcept
+{
+    // e.g., "Statement for BigCo\n"
+    constexpr auto header_size = std::size("Statement for \n"sv);
+    // e.g., "  Othello: $500.00 (40 seats)\n"
+    constexpr std::size_t line_size = 40;
+    // e.g., "Amount owed is $1,730.00\nYou earned 47 credits\n"
+    constexpr std::size_t footer_size = 48;
+    return header_size + std::size(invoice.customer) +
+        line_size * std::size(invoice.performances) + footer_size;
+}
+
+// Write the parts of a statement to `out`: the header for `customer`,
+// the line charging `amount` for a performance of `play_name` with `audience` seats,
+// and the footer with the totals;
+// `render_footer` throws `std::overflow_error` if `total_amount` is saturated.
+// `render_usd_line` and `render_usd_footer` take the amounts as `Usd` or formatted already
+// (e.g., to time formatting them by itself).
+template<typename Out>
+Out render_header(Out out, std::string_view customer)
+{
+    return std::format_to(out, "Statement for {}\n"sv, customer);
+}
+
+template<typename Out, typename Amount>
+Out render_usd_line(Out out, std::string_view play_name, const Amount& usd, int audience)
+{
+    return std::format_to(out, "  {}: {} ({} seats)\n"sv, play_name, usd, audience);
+}
+
+template<typename Out>
+Out render_line(Out out, std::string_view play_name, std::int64_t amount, int audience)
+{
+    return render_usd_line(out, play_name, Usd{amount}, audience);
+}
+
+template<typename Out, typename Amount>
+Out render_usd_footer(Out out, const Amount& usd, std::int64_t volume_credits)
+{
+    out = std::format_to(out, "Amount owed is {}\n"sv, usd);
+    return std::format_to(out, "You earned {} credits\n"sv, volume_credits);
+}
+
+template<typename Out>
+Out render_footer(Out out, Money total_amount, std::int64_t volume_credits)
+{
+    return render_usd_footer(out, Usd{checked(total_amount).units()}, volume_credits);
+}
+
+// Output iterator counting the characters written through it into `*count`
+template<typename Out>
+class CountingOutput
+{
+public:
+    using difference_type = std::ptrdiff_t;
+
+    CountingOutput(Out out, std::uint64_t& count) : out_{out}, count_{&count} {}
+
+    CountingOutput& operator*() noexcept { return *this; }
+    CountingOutput& operator++() noexcept { return *this; }
+    CountingOutput& operator++(int) noexcept { return *this; }
+
+    CountingOutput& operator=(char c)
+    {
+        *out_ = c;
+        ++out_;
+        ++*count_;
+        return *this;
+    }
+
+    Out base() const { return out_; }
+
+private:
+    Out out_;
+    std::uint64_t* count_;
+};
+
+// Totals of a statement rendered
+struct StatementTotals
+{
+    Money amount;
+    std::int64_t volume_credits = 0;
+};
+
+// Does the same as `render_statement` while timing each phase and counting into `metrics`
+// (with the currency formatted apart from the rest of each line to be timed by itself
+// through `render_usd_line` and `render_usd_footer`).
+template<typename Out, typename AnyInvoice, typename Plays>
+Out render_statement_instrumented(
+    Out out, const AnyInvoice& invoice, const Plays& plays,
+    StatementTotals& totals, StatementMetrics& metrics)
+{
+    using Clock = std::chrono::steady_clock;
+    CountingOutput counting{out, metrics.bytes};
+
+    auto format_usd = [&](std::array<char, 64>& buffer, Money amount)
+    {
+        const auto start = Clock::now();
+        const auto end =
+            std::format_to_n(std::data(buffer), std::ssize(buffer), "{}"sv, Usd{amount.units()}).out;
+        metrics.currency += Clock::now() - start;
+        return std::string_view{std::data(buffer), end};
+    };
+
+    Money total_amount;
+    std::int64_t volume_credits = 0;
+    auto start = Clock::now();
+    counting = render_header(counting, invoice.customer);
+    metrics.formatting += Clock::now() - start;
+
+    for (const auto& perf : invoice.performances) {
+        start = Clock::now();
+        const auto& play = [&]() -> decltype(auto)
+        {
+            try {
+                return play_for(plays, perf);
+            }
+            catch (const std::out_of_range&) {
+                ++metrics.catalog_misses;
+                throw;
+            }
+        }();
+        auto now = Clock::now();
+        metrics.lookup += now - start;
+
+        start = now;
+        const auto this_amount = amount_for(play.type, perf.audience);
+        volume_credits += volume_credits_for(play.type, perf.audience);
+        metrics.pricing += Clock::now() - start;
+
+        std::array<char, 64> usd_buffer;
+        const auto usd = format_usd(usd_buffer, Money{this_amount});
+        start = Clock::now();
+        counting = render_usd_line(counting, play.name, usd, perf.audience);
+        metrics.formatting += Clock::now() - start;
+        ++metrics.lines;
+        total_amount += Money{this_amount};
+    }
+
+    std::array<char, 64> usd_buffer;
+    const auto usd = format_usd(usd_buffer, checked(total_amount));
+    start = Clock::now();
+    counting = render_usd_footer(counting, usd, volume_credits);
+    metrics.formatting += Clock::now() - start;
+    ++metrics.statements;
+    totals = {.amount = total_amount, .volume_credits = volume_credits};
+    return counting.base();
+}
+
+// Writes the statement for `invoice` to `out`, where `invoice` may be of any type with
+// a `customer` and a range of `performances`, each of which has an `audience`, as long as
+// `play_for(plays, perf)` finds the play (with its `name` and `type`) for each performance;
+// collects `StatementMetrics` if enabled. Also returns the totals in `totals` if given.
+template<typename Out, typename AnyInvoice, typename Plays>
+Out render_statement(Out out, const AnyInvoice& invoice, const Plays& plays, StatementTotals& totals)
+{
+    if (statement_metrics_enabled()) [[unlikely]] {
+        StatementMetrics metrics;
+        try {
+            out = render_statement_instrumented(out, invoice, plays, totals, metrics);
+        }
+        catch (...) {
+            add_statement_metrics(metrics);
+            throw;
+        }
+        add_statement_metrics(metrics);
+        return out;
+    }
+
+    Money total_amount;
+    std::int64_t volume_credits = 0;
+    out = render_header(out, invoice.customer);
+
+    for (const auto& perf : invoice.performances) {
+        const auto& play = play_for(plays, perf);
+        const auto this_amount = amount_for(play.type, perf.audience);
+        volume_credits += volume_credits_for(play.type, perf.audience);
+
+        // print line for this order
+        out = render_line(out, play.name, this_amount, perf.audience);
+        total_amount += Money{this_amount};
+    }
+
+    out = render_footer(out, total_amount, volume_credits);
+    totals = {.amount = total_amount, .volume_credits = volume_credits};
+    return out;
+}
+
+template<typename Out, typename AnyInvoice, typename Plays>
+Out render_statement(Out out, const AnyInvoice& invoice, const Plays& plays)
+{
+    StatementTotals totals;
+    return render_statement(out, invoice, plays, totals);
+}
+
+// Returns the sum of `estimated_statement_size` for `invoices`.
+template<typename Invoices>
+std::size_t estimated_statements_size(const Invoices& invoices) noexcept
+{
+    std::size_t size = 0;
+    for (const auto& invoice : invoices) { size += estimated_statement_size(invoice); }
+    return size;
+}
+
+template<typename Out, typename Invoices, typename Plays>
+Out render_statements(Out out, const Invoices& invoices, const Plays& plays)
+{
+    for (const auto& invoice : invoices) { out = render_statement(out, invoice, plays); }
+    return out;
+}
+
+// Append the statements for `invoices` to `out` or write them to `os` as `statements` does.
+template<typename AnyInvoice, typename Plays>
+void render_statements(std::span<const AnyInvoice> invoices, const Plays& plays, std::string& out)
+{
+    out.reserve(std::size(out) + estimated_statements_size(invoices));
+    render_statements(std::back_inserter(out), invoices, plays);
+}
+
+template<typename AnyInvoice, typename Plays>
+void render_statements(std::span<const AnyInvoice> invoices, const Plays& plays, std::ostream& os)
+{
+    const std::ostream::sentry sentry{os};
+    if (!sentry) { return; }
+    // write directly into the stream buffer (rather than formatting into a string first)
+    if (render_statements(std::ostreambuf_iterator<char>{os}, invoices, plays).failed()) {
+        os.setstate(std::ios_base::badbit);
+    }
+}
+
+// Performances of the invoices in `Invoices` (e.g., `PerformanceView` for `InvoiceView`)
+template<typename Invoices>
+using PerformanceOf = std::ranges::range_value_t<decltype(std::ranges::range_value_t<Invoices>::performances)>;
+
+// Return the statement for `invoice`, append the statements for `invoices` to `out`, or
+// write them to `os` with any `PlayLookup`, e.g., a user-defined one (beyond those
+// `statement` and `statements` in statement.h are compiled for), for any kind of invoices
+// laid out contiguously (e.g., in a `std::vector`).
+template<typename AnyInvoice, typename Plays>
+    requires PlayLookup<Plays, std::ranges::range_value_t<decltype(AnyInvoice::performances)>>
+std::string statement(const AnyInvoice& invoice, const Plays& plays)
+{
+    std::string out;
+    out.reserve(estimated_statement_size(invoice));
+    render_statement(std::back_inserter(out), invoice, plays);
+    return out;
+}
+
+template<std::ranges::contiguous_range Invoices, typename Plays>
+    requires PlayLookup<Plays, PerformanceOf<Invoices>>
+void statements(const Invoices& invoices, const Plays& plays, std::string& out)
+{
+    render_statements(std::span<const std::ranges::range_value_t<Invoices>>{invoices}, plays, out);
+}
+
+template<std::ranges::contiguous_range Invoices, typename Plays>
+    requires PlayLookup<Plays, PerformanceOf<Invoices>>
+void statements(const Invoices& invoices, const Plays& plays, std::ostream& os)
+{
+    render_statements(std::span<const std::ranges::range_value_t<Invoices>>{invoices}, plays, os);
+}
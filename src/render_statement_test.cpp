@@ -0,0 +1,155 @@
+#include "pch.h"
+
+#include "render_statement.h"
+
+#include <gtest/gtest.h>
+#include <gmock/gmock.h>
+
+using namespace testing;
+
+namespace {
+
+// Plays looked up by a sorted array, plugged in as a `PlayLookup`
+struct SortedPlays
+{
+    std::vector<std::pair<std::string, Play>> plays;
+};
+
+const Play& play_for(const SortedPlays& sorted, const Performance& perf)
+{
+    const auto it = std::ranges::lower_bound(
+        sorted.plays, perf.play_id, std::less<>{}, &std::pair<std::string, Play>::first);
+    if (it == std::cend(sorted.plays) || it->first != perf.play_id) {
+        throw std::out_of_range{perf.play_id};
+    }
+    return it->second;
+}
+
+TEST(RenderStatementTest, Usd)
+{
+    EXPECT_EQ(std::format("{}"sv, Usd{173000}), "$1,730.00"s);
+    EXPECT_EQ(std::format("[{}]"sv, Usd{5}), "[$0.05]"s);
+    EXPECT_EQ(std::format("{}"sv, Usd{0}), "$0.00"s);
+    const Usd zero{0};
+    EXPECT_THROW(std::ignore = std::vformat("{:x}"sv, std::make_format_args(zero)), std::format_error);
+
+    std::array<char, 8> buffer;
+    const auto [out, size] = std::format_to_n(std::data(buffer), std::ssize(buffer), "{}"sv, Usd{173000});
+    EXPECT_EQ(size, 9);
+    EXPECT_EQ((std::string_view{std::data(buffer), out}), "$1,730.0"sv);
+}
+
+TEST(RenderStatementTest, UsdByLocale)
+{
+    try {
+        std::ignore = std::locale{"en_US.UTF-8"s};
+    }
+    catch (const std::runtime_error&) {
+        GTEST_SKIP() << "en_US.UTF-8 is not installed";
+    }
+
+    const std::locale loc{"en_US.UTF-8"s};
+    for (const auto cents : {173000, 65000, 5, 0, 123456789}) {
+        EXPECT_EQ(std::format(loc, "{:L}"sv, Usd{cents}), std::format("{}"sv, Usd{cents}));
+    }
+}
+
+TEST(RenderStatementTest, UsdByLocaleOfFormatting)
+{
+    // no currency symbol nor fractional digits in the classic locale
+    EXPECT_EQ(std::format(std::locale::classic(), "{:L}"sv, Usd{173000}), "173000"s);
+}
+
+TEST(RenderStatementTest, UsdByLocaleWithLongSymbol)
+{
+    // currency symbol too long to format on the stack
+    class LongPunct final : public std::moneypunct<char>
+    {
+    protected:
+        std::string do_curr_symbol() const override { return std::string(100, '$'); }
+        int do_frac_digits() const override { return 2; }
+    };
+
+    const std::locale loc{std::locale::classic(), new LongPunct};
+    EXPECT_EQ(std::format(loc, "{:L}"sv, Usd{173000}), std::string(100, '$') + "1730.00"s);
+}
+
+TEST(RenderStatementTest, EstimatedStatementSize)
+{
+    const Invoice invoice{
+        .customer = "BigCo"s,
+        .performances = {
+            {
+                .play_id = "hamlet"s,
+                .audience = 55
+            },
+            {
+                .play_id = "as-like"s,
+                .audience = 35
+            },
+            {
+                .play_id = "othello"s,
+                .audience = 40
+            },
+        }
+    };
+
+    const std::map<std::string, Play> plays{
+        {"hamlet"s, {.name = "Hamlet"s, .type = Play::Type::Tragedy}},
+        {"as-like"s, {.name = "As You Like It"s, .type = Play::Type::Comedy}},
+        {"othello"s, {.name = "Othello"s, .type = Play::Type::Tragedy}},
+    };
+
+    // close enough to reserve once
+    const auto size = std::size(statement(invoice, plays));
+    EXPECT_GE(estimated_statement_size(invoice), size);
+    EXPECT_LE(estimated_statement_size(invoice), 2 * size);
+    EXPECT_EQ(estimated_statements_size(std::array{invoice, invoice}), 2 * estimated_statement_size(invoice));
+}
+
+TEST(RenderStatementTest, AnyPlayLookup)
+{
+    const std::map<std::string, Play, std::less<>> plays{
+        {"hamlet"s, {.name = "Hamlet"s, .type = Play::Type::Tragedy}},
+        {"as-like"s, {.name = "As You Like It"s, .type = Play::Type::Comedy}},
+    };
+    const SortedPlays sorted_plays{{std::cbegin(plays), std::cend(plays)}};
+
+    static_assert(PlayLookup<PlayHashMap>);
+    static_assert(PlayLookup<decltype(plays), PerformanceView>);
+    static_assert(PlayLookup<SortedPlays>);
+    static_assert(!PlayLookup<std::vector<Play>>);
+
+    const Invoice invoice{
+        .customer = "BigCo"s,
+        .performances = {
+            {.play_id = "hamlet"s, .audience = 55},
+            {.play_id = "as-like"s, .audience = 35},
+        }
+    };
+
+    const auto expected_text = R"###(Statement for BigCo
+  Hamlet: $650.00 (55 seats)
+  As You Like It: $580.00 (35 seats)
+Amount owed is $1,230.00
+You earned 37 credits
+)###"s;
+
+    EXPECT_EQ(statement(invoice, plays), expected_text);
+    EXPECT_EQ(statement(invoice, sorted_plays), expected_text);
+
+    // and so are the statements for a batch of invoices
+    const std::vector invoices{invoice, invoice};
+    std::string out;
+    statements(invoices, sorted_plays, out);
+    EXPECT_EQ(out, expected_text + expected_text);
+    std::ostringstream oss;
+    statements(invoices, sorted_plays, oss);
+    EXPECT_EQ(oss.str(), expected_text + expected_text);
+
+    const std::array performances{PerformanceView{.play_id = "macbeth"sv, .audience = 10}};
+    const InvoiceView unknown{.customer = "BigCo"sv, .performances = performances};
+    EXPECT_THROW(statement(unknown, plays), std::out_of_range);
+}
+
+}
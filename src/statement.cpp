@@ -2,60 +2,584 @@
 
 #include "statement.h"
 
+#include "line_cache.h"
+#include "play_catalog.h"
+#include "render_statement.h"
+
 namespace {
 
-auto usd(int amount)
+const Play* find_play(const std::map<std::string, Play>& plays, const Performance& perf) noexcept
 {
-    std::ostringstream oss;
-    oss.imbue(std::locale{"en_US.UTF-8"s});
-    oss << std::showbase << std::put_money(amount);
-    return std::move(oss).str();
+    const auto it = plays.find(perf.play_id);
+    return it != std::cend(plays) ? &it->second : nullptr;
 }
 
+const Play* find_play(const PlayCatalog& plays, const Performance& perf) noexcept
+{
+    return plays.find_play(perf);
 }
 
-std::string statement(const Invoice& invoice, const std::map<std::string, Play>& plays)
+const Play* find_play(const PlayHashMap& plays, const Performance& perf) noexcept
+{
+    const auto it = plays.find(std::string_view{perf.play_id});
+    return it != std::cend(plays) ? &it->second : nullptr;
+}
+
+// Appends the statement for `invoice` (at `index` in the batch) to `out`
+// if it has no errors in `plays` or returns the first error otherwise (leaving `out` intact),
+// counting into `counts`
+template<typename Plays>
+std::optional<StatementError> render_statement_or_error(
+    const Invoice& invoice, std::size_t index, const Plays& plays, std::string& out, StatementCounts& counts)
+{
+    // render optimistically and roll back on error (which is rare) not to look up plays twice
+    const auto size = std::size(out);
+    std::uint64_t lines = 0;
+    auto error = [&](StatementError::Code code, std::size_t performance, Play::Type type)
+    {
+        // counting what has been rendered (as `render_statement` does) before rolling it back
+        counts.add(0, lines, std::size(out) - size);
+        out.resize(size);
+        return StatementError{.code = code, .invoice = index, .performance = performance, .type = type};
+    };
+
+    Money total_amount;
+    std::int64_t volume_credits = 0;
+    auto it = render_header(std::back_inserter(out), invoice.customer);
+
+    for (std::size_t i = 0; i < std::size(invoice.performances); ++i) {
+        const auto& perf = invoice.performances[i];
+        const auto play = find_play(plays, perf);
+        if (!play) {
+            counts.add_catalog_miss();
+            const bool by_handle =
+                std::is_same_v<Plays, PlayCatalog> && perf.play_handle != PlayHandle::unresolved;
+            return error(
+                by_handle ? StatementError::Code::invalid_play_handle : StatementError::Code::unknown_play_id,
+                i, Play::Type{});
+        }
+        if (!KnownPlayTypes::contains(play->type)) {
+            return error(StatementError::Code::unknown_type, i, play->type);
+        }
+
+        const auto this_amount = amount_for(play->type, perf.audience);
+        volume_credits += volume_credits_for(play->type, perf.audience);
+        it = render_line(it, play->name, this_amount, perf.audience);
+        ++lines;
+        total_amount += Money{this_amount};
+    }
+
+    if (total_amount.saturated()) { return error(StatementError::Code::overflow, 0, Play::Type{}); }
+    render_footer(it, total_amount, volume_credits);
+    counts.add(1, lines, std::size(out) - size);
+    return std::nullopt;
+}
+
+template<typename Plays>
+void render_statements(
+    std::span<const Invoice> invoices, const Plays& plays, std::string& out,
+    std::vector<StatementError>& errors)
+{
+    out.reserve(std::size(out) + estimated_statements_size(invoices));
+    StatementCounts counts;
+    for (std::size_t i = 0; i < std::size(invoices); ++i) {
+        if (const auto error = render_statement_or_error(invoices[i], i, plays, out, counts)) {
+            errors.push_back(*error);
+        }
+    }
+}
+
+// Plays with the cache of the lines rendered for them
+struct CachedPlays
 {
-    int total_amount = 0;
-    int volume_credits = 0;
-    std::ostringstream oss;
-    oss << std::format("Statement for {}\n"sv, invoice.customer);
+    const PlayCatalog& plays;
+    LineCache& cache;
+};
+
+// Appends the line for `perf` to `out` and returns its price, counting into `counts`.
+template<typename Plays>
+LinePrice render_performance(
+    const Performance& perf, const Plays& plays, std::string& out, StatementCounts& counts)
+{
+    const auto& play = counts.look_up([&]() -> decltype(auto) { return play_for(plays, perf); });
+    const LinePrice price{
+        .amount = amount_for(play.type, perf.audience),
+        .volume_credits = volume_credits_for(play.type, perf.audience)
+    };
+    const auto first = std::size(out);
+    render_line(std::back_inserter(out), play.name, price.amount, perf.audience);
+    counts.add(0, 1, std::size(out) - first);
+    return price;
+}
+
+LinePrice render_performance(
+    const Performance& perf, const CachedPlays& cached, std::string& out, StatementCounts& counts)
+{
+    const auto handle = counts.look_up([&] { return cached.plays.handle_for(perf); });
+    const auto first = std::size(out);
+    if (const auto price = cached.cache.append_to(handle, perf.audience, out)) {
+        counts.add(0, 1, std::size(out) - first);
+        return *price;
+    }
+
+    const auto& play = cached.plays[handle];
+    const LinePrice price{
+        .amount = amount_for(play.type, perf.audience),
+        .volume_credits = volume_credits_for(play.type, perf.audience)
+    };
+    render_line(std::back_inserter(out), play.name, price.amount, perf.audience);
+    cached.cache.insert(handle, perf.audience, std::string_view{out}.substr(first), price);
+    counts.add(0, 1, std::size(out) - first);
+    return price;
+}
+
+// Appends the statement for `invoice` to `out` (reserved by the caller),
+// counting into `counts` unless `render_statement` collects the metrics itself.
+template<typename Plays>
+void render_invoice(const Invoice& invoice, const Plays& plays, std::string& out, StatementCounts&)
+{
+    render_statement(std::back_inserter(out), invoice, plays);
+}
+
+void render_invoice(
+    const Invoice& invoice, const CachedPlays& cached, std::string& out, StatementCounts& counts)
+{
+    Money total_amount;
+    std::int64_t volume_credits = 0;
+    auto first = std::size(out);
+    render_header(std::back_inserter(out), invoice.customer);
+    counts.add(0, 0, std::size(out) - first);
 
     for (const auto& perf : invoice.performances) {
-        const auto& play = plays.at(perf.play_id);
-        int this_amount = 0;
-
-        switch (play.type) {
-        case Play::Type::Tragedy:
-            this_amount = 40000;
-            if (perf.audience > 30) {
-                this_amount += 1000 * (perf.audience - 30);
+        const auto price = render_performance(perf, cached, out, counts);
+        total_amount += Money{price.amount};
+        volume_credits += price.volume_credits;
+    }
+
+    first = std::size(out);
+    render_footer(std::back_inserter(out), total_amount, volume_credits);
+    counts.add(1, 0, std::size(out) - first);
+}
+
+void render_statements(std::span<const Invoice> invoices, const CachedPlays& cached, std::string& out)
+{
+    out.reserve(std::size(out) + estimated_statements_size(invoices));
+    StatementCounts counts;
+    for (const auto& invoice : invoices) { render_invoice(invoice, cached, out, counts); }
+}
+
+// Work-stealing scheduler of the tasks numbered [0, num_tasks) among `num_workers`,
+// each of which takes its own share of the tasks from the front and, once done,
+// steals the remaining tasks of the others from the back
+// (so that the workers contend only when they run out of their own).
+class TaskDeques
+{
+public:
+    TaskDeques(std::size_t num_tasks, std::size_t num_workers) :
+        deques_(num_workers)
+    {
+        for (std::size_t i = 0; i < num_workers; ++i) {
+            deques_[i].range = pack(num_tasks * i / num_workers, num_tasks * (i + 1) / num_workers);
+        }
+    }
+
+    // Returns the next task for the worker numbered `worker` or `std::nullopt` if none is left.
+    std::optional<std::size_t> next(std::size_t worker) noexcept
+    {
+        if (const auto task = pop(deques_[worker], true)) { return task; }
+        for (std::size_t i = 1; i < std::size(deques_); ++i) {
+            if (const auto task = pop(deques_[(worker + i) % std::size(deques_)], false)) { return task; }
+        }
+        return std::nullopt;
+    }
+
+private:
+    // tasks [first, last) not taken yet, packed into a word to be updated at once
+    struct alignas(64) Deque
+    {
+        std::atomic<std::uint64_t> range;
+    };
+
+    static std::uint64_t pack(std::uint64_t first, std::uint64_t last) noexcept { return first << 32 | last; }
+
+    static std::optional<std::size_t> pop(Deque& deque, bool front) noexcept
+    {
+        auto range = deque.range.load();
+        while (true) {
+            const auto first = range >> 32;
+            const auto last = range & 0xffff'ffff;
+            if (first == last) { return std::nullopt; }
+            const auto task = front ? first : last - 1;
+            if (deque.range.compare_exchange_weak(range, front ? pack(first + 1, last) : pack(first, task))) {
+                return static_cast<std::size_t>(task);
+            }
+        }
+    }
+
+    std::vector<Deque> deques_;
+};
+
+template<typename Plays>
+void render_statements_in_parallel(std::span<const Invoice> invoices, const Plays& plays, std::string& out)
+{
+    // split the headers and the lines of all the invoices evenly into tasks (splitting large invoices),
+    // where invoice `i` covers the units [first_units[i], first_units[i + 1]) for its header and lines
+    std::vector<std::size_t> first_units(std::size(invoices) + 1);
+    std::transform_inclusive_scan(
+        std::cbegin(invoices), std::cend(invoices), std::next(std::begin(first_units)),
+        std::plus{}, [](const auto& invoice) { return 1 + std::size(invoice.performances); });
+    const auto num_units = first_units.back();
+
+    const auto num_workers = static_cast<std::size_t>(std::max(std::thread::hardware_concurrency(), 1u));
+    // several tasks per worker so that the workers finishing early can take over the rest
+    const auto num_tasks = std::min(num_units, 8 * num_workers);
+    if (num_workers == 1 || num_tasks <= 1) {
+        const auto size = std::size(out);
+        try {
+            render_statements(invoices, plays, out);
+        }
+        catch (...) {
+            out.resize(size);
+            throw;
+        }
+        return;
+    }
+
+    // part of an invoice split across tasks, whose footer is rendered once all its parts are done
+    struct Part
+    {
+        std::size_t invoice;
+        Money amount;
+        std::int64_t volume_credits;
+        // where the footer goes in the text of the task if the invoice ends in it
+        std::optional<std::size_t> footer_at;
+    };
+    struct Task
+    {
+        std::string text;
+        // the invoices at the both ends of the task if split
+        std::vector<Part> parts;
+        std::exception_ptr error;
+        // index of the invoice being rendered when `error` was thrown
+        std::size_t failed_invoice;
+    };
+    std::vector<Task> tasks(num_tasks);
+
+    auto render_task = [&](std::size_t t)
+    {
+        const auto first_unit = num_units * t / num_tasks;
+        const auto last_unit = num_units * (t + 1) / num_tasks;
+        auto& task = tasks[t];
+        StatementCounts counts;
+        const auto first_invoice = static_cast<std::size_t>(std::distance(
+            std::cbegin(first_units),
+            std::upper_bound(std::cbegin(first_units), std::cend(first_units), first_unit)) - 1);
+        auto current_invoice = first_invoice;
+        try {
+            auto last_invoice = first_invoice;
+            // reserve the text once for (the share of) each invoice the task covers
+            std::size_t size = 0;
+            while (last_invoice < std::size(invoices) && first_units[last_invoice] < last_unit) {
+                const auto i = last_invoice++;
+                const auto units =
+                    std::min(first_units[i + 1], last_unit) - std::max(first_units[i], first_unit);
+                size += estimated_statement_size(invoices[i]) * units / (first_units[i + 1] - first_units[i]);
+            }
+            task.text.reserve(size);
+
+            for (auto i = first_invoice; i < last_invoice; ++i) {
+                current_invoice = i;
+                const auto& invoice = invoices[i];
+                const auto first = std::max(first_units[i], first_unit);
+                const auto last = std::min(first_units[i + 1], last_unit);
+                if (first == first_units[i] && last == first_units[i + 1]) {
+                    render_invoice(invoice, plays, task.text, counts);
+                    continue;
+                }
+
+                Part part{.invoice = i, .amount = Money{}, .volume_credits = 0, .footer_at = std::nullopt};
+                if (first == first_units[i]) {
+                    const auto header_at = std::size(task.text);
+                    render_header(std::back_inserter(task.text), invoice.customer);
+                    counts.add(0, 0, std::size(task.text) - header_at);
+                }
+                for (auto unit = std::max(first, first_units[i] + 1); unit < last; ++unit) {
+                    const auto price = render_performance(
+                        invoice.performances[unit - first_units[i] - 1], plays, task.text, counts);
+                    part.amount += Money{price.amount};
+                    part.volume_credits += price.volume_credits;
+                }
+                if (last == first_units[i + 1]) { part.footer_at = std::size(task.text); }
+                task.parts.push_back(part);
             }
-            break;
-        case Play::Type::Comedy:
-            this_amount = 30000;
-            if (perf.audience > 20) {
-                this_amount += 10000 + 500 * (perf.audience - 20);
+        }
+        catch (...) {
+            task.error = std::current_exception();
+            task.failed_invoice = current_invoice;
+        }
+    };
+
+    {
+        const auto num_threads = std::min(num_workers, num_tasks);
+        TaskDeques deques{num_tasks, num_threads};
+        auto work = [&](std::size_t worker)
+        {
+            while (const auto t = deques.next(worker)) { render_task(*t); }
+        };
+
+        std::vector<std::jthread> workers;
+        workers.reserve(num_threads - 1);
+        for (std::size_t i = 1; i < num_threads; ++i) { workers.emplace_back(work, i); }
+        work(0);
+    }
+
+    // reduce the subtotals of each split invoice in order (for its footer after its last line)
+    struct Totals
+    {
+        std::size_t invoice;
+        Money amount;
+        std::int64_t volume_credits;
+    };
+    std::vector<Totals> split_totals;
+    for (const auto& task : tasks) {
+        for (const auto& part : task.parts) {
+            if (split_totals.empty() || split_totals.back().invoice != part.invoice) {
+                split_totals.push_back({.invoice = part.invoice, .amount = Money{}, .volume_credits = 0});
             }
-            this_amount += 300 * perf.audience;
-            break;
-        default:
-            throw std::runtime_error{std::format(
-                "{}: unknown Play::Type"sv,
-                static_cast<std::underlying_type_t<Play::Type>>(play.type))};
+            split_totals.back().amount += part.amount;
+            split_totals.back().volume_credits += part.volume_credits;
         }
+    }
+
+    // report the error that the sequential rendering would have encountered first
+    // before appending anything to leave `out` intact: the overflow of a split invoice
+    // before the earliest failed one (whose error is thrown by the first failed task) or the latter
+    const auto failed = std::ranges::find_if(tasks, [](const auto& task) { return task.error != nullptr; });
+    const auto failed_invoice = failed != std::cend(tasks) ? failed->failed_invoice : std::size(invoices);
+    for (const auto& totals : split_totals) {
+        if (totals.invoice >= failed_invoice) { break; }
+        checked(totals.amount);
+    }
+    if (failed != std::cend(tasks)) { std::rethrow_exception(failed->error); }
+
+    out.reserve(std::size(out) + std::transform_reduce(
+        std::cbegin(tasks), std::cend(tasks), std::size_t{0},
+        std::plus{}, [](const auto& task) { return std::size(task.text); }));
+    StatementCounts counts;
+    auto totals = std::cbegin(split_totals);
+    for (const auto& task : tasks) {
+        std::size_t written = 0;
+        for (const auto& part : task.parts) {
+            if (part.footer_at) {
+                out.append(task.text, written, *part.footer_at - written);
+                const auto footer_at = std::size(out);
+                render_footer(std::back_inserter(out), totals->amount, totals->volume_credits);
+                counts.add(1, 0, std::size(out) - footer_at);
+                ++totals;
+                written = *part.footer_at;
+            }
+        }
+        out.append(task.text, written);
+    }
+}
+
+}
+
+std::string statement(const Invoice& invoice, const std::map<std::string, Play>& plays)
+{
+    std::string out;
+    render_statements(std::span{&invoice, 1}, plays, out);
+    return out;
+}
+
+std::string statement(const Invoice& invoice, const PlayCatalog& plays)
+{
+    std::string out;
+    render_statements(std::span{&invoice, 1}, plays, out);
+    return out;
+}
+
+std::string statement(const Invoice& invoice, const PlayHashMap& plays)
+{
+    std::string out;
+    render_statements(std::span{&invoice, 1}, plays, out);
+    return out;
+}
+
+std::string statement(const pmr::Invoice& invoice, const std::map<std::string, Play>& plays)
+{
+    std::string out;
+    render_statements(std::span{&invoice, 1}, plays, out);
+    return out;
+}
+
+std::string statement(const pmr::Invoice& invoice, const PlayCatalog& plays)
+{
+    std::string out;
+    render_statements(std::span{&invoice, 1}, plays, out);
+    return out;
+}
+
+std::string statement(const pmr::Invoice& invoice, const PlayHashMap& plays)
+{
+    std::string out;
+    render_statements(std::span{&invoice, 1}, plays, out);
+    return out;
+}
+
+std::string statement(const InvoiceView& invoice, const std::map<std::string, Play>& plays)
+{
+    std::string out;
+    render_statements(std::span{&invoice, 1}, plays, out);
+    return out;
+}
+
+std::string statement(const InvoiceView& invoice, const PlayCatalog& plays)
+{
+    std::string out;
+    render_statements(std::span{&invoice, 1}, plays, out);
+    return out;
+}
+
+std::string statement(const InvoiceView& invoice, const PlayHashMap& plays)
+{
+    std::string out;
+    render_statements(std::span{&invoice, 1}, plays, out);
+    return out;
+}
+
+void statements(
+    std::span<const Invoice> invoices, const std::map<std::string, Play>& plays, std::string& out)
+{
+    render_statements(invoices, plays, out);
+}
+
+void statements(std::span<const Invoice> invoices, const PlayCatalog& plays, std::string& out)
+{
+    render_statements(invoices, plays, out);
+}
+
+void statements(std::span<const Invoice> invoices, const PlayHashMap& plays, std::string& out)
+{
+    render_statements(invoices, plays, out);
+}
+
+void statements(
+    std::span<const pmr::Invoice> invoices, const std::map<std::string, Play>& plays, std::string& out)
+{
+    render_statements(invoices, plays, out);
+}
+
+void statements(std::span<const pmr::Invoice> invoices, const PlayCatalog& plays, std::string& out)
+{
+    render_statements(invoices, plays, out);
+}
+
+void statements(std::span<const pmr::Invoice> invoices, const PlayHashMap& plays, std::string& out)
+{
+    render_statements(invoices, plays, out);
+}
+
+void statements(
+    std::span<const InvoiceView> invoices, const std::map<std::string, Play>& plays, std::string& out)
+{
+    render_statements(invoices, plays, out);
+}
 
-        // add volume credits
-        volume_credits += std::max(perf.audience - 30, 0);
-        // add extra credit for every ten comedy attendees
-        if (Play::Type::Comedy == play.type) { volume_credits += perf.audience / 5; }
+void statements(std::span<const InvoiceView> invoices, const PlayCatalog& plays, std::string& out)
+{
+    render_statements(invoices, plays, out);
+}
 
-        // print line for this order
-        oss << std::format("  {}: {} ({} seats)\n"sv, play.name, usd(this_amount), perf.audience);
-        total_amount += this_amount;
+void statements(std::span<const InvoiceView> invoices, const PlayHashMap& plays, std::string& out)
+{
+    render_statements(invoices, plays, out);
+}
+
+std::string message(const StatementError& error, std::span<const Invoice> invoices)
+{
+    switch (error.code) {
+    case StatementError::Code::unknown_play_id:
+        return std::format(
+            "{}: unknown play ID"sv, invoices[error.invoice].performances[error.performance].play_id);
+    case StatementError::Code::invalid_play_handle:
+        return "invalid play handle"s;
+    case StatementError::Code::unknown_type:
+        return std::format(
+            "{}: unknown Play::Type"sv, static_cast<std::underlying_type_t<Play::Type>>(error.type));
+    case StatementError::Code::overflow:
+        return std::format("{}: total amount overflow"sv, invoices[error.invoice].customer);
     }
+    return "unknown error"s;
+}
+
+void statements(
+    std::span<const Invoice> invoices, const std::map<std::string, Play>& plays, std::string& out,
+    std::vector<StatementError>& errors)
+{
+    render_statements(invoices, plays, out, errors);
+}
+
+void statements(
+    std::span<const Invoice> invoices, const PlayCatalog& plays, std::string& out,
+    std::vector<StatementError>& errors)
+{
+    render_statements(invoices, plays, out, errors);
+}
+
+void statements(
+    std::span<const Invoice> invoices, const PlayHashMap& plays, std::string& out,
+    std::vector<StatementError>& errors)
+{
+    render_statements(invoices, plays, out, errors);
+}
+
+void statements(
+    std::span<const Invoice> invoices, const std::map<std::string, Play>& plays, std::ostream& os)
+{
+    render_statements(invoices, plays, os);
+}
+
+void statements(std::span<const Invoice> invoices, const PlayCatalog& plays, std::ostream& os)
+{
+    render_statements(invoices, plays, os);
+}
+
+void statements(std::span<const Invoice> invoices, const PlayHashMap& plays, std::ostream& os)
+{
+    render_statements(invoices, plays, os);
+}
+
+void statements(
+    const std::execution::parallel_policy&,
+    std::span<const Invoice> invoices, const std::map<std::string, Play>& plays, std::string& out)
+{
+    render_statements_in_parallel(invoices, plays, out);
+}
 
-    oss << std::format("Amount owed is {}\n"sv, usd(total_amount));
-    oss << std::format("You earned {} credits\n"sv, volume_credits);
-    return std::move(oss).str();
+void statements(
+    const std::execution::parallel_policy&,
+    std::span<const Invoice> invoices, const PlayCatalog& plays, std::string& out)
+{
+    render_statements_in_parallel(invoices, plays, out);
+}
+
+void statements(
+    const std::execution::parallel_policy&,
+    std::span<const Invoice> invoices, const PlayHashMap& plays, std::string& out)
+{
+    render_statements_in_parallel(invoices, plays, out);
+}
+
+void statements(
+    std::span<const Invoice> invoices, const PlayCatalog& plays, LineCache& cache, std::string& out)
+{
+    render_statements(invoices, CachedPlays{.plays = plays, .cache = cache}, out);
+}
+
+void statements(
+    const std::execution::parallel_policy&,
+    std::span<const Invoice> invoices, const PlayCatalog& plays, LineCache& cache, std::string& out)
+{
+    render_statements_in_parallel(invoices, CachedPlays{.plays = plays, .cache = cache}, out);
 }
@@ -12,10 +12,34 @@ struct Play
     Type type;
 };
 
+// Hash of strings accepting any string-like key (with `std::equal_to<>`)
+// for heterogeneous lookup without materializing a `std::string`
+struct StringHash
+{
+    using is_transparent = void;
+
+    std::size_t operator()(std::string_view str) const noexcept
+    {
+        return std::hash<std::string_view>{}(str);
+    }
+};
+
+// Hash map of plays from their IDs, which can be looked up by `std::string_view`
+// in constant time (unlike `std::map<std::string, Play>` with its tree traversal)
+using PlayHashMap = std::unordered_map<std::string, Play, StringHash, std::equal_to<>>;
+
+// Dense index of a play in a `PlayCatalog`
+enum class PlayHandle : std::uint32_t
+{
+    unresolved = std::numeric_limits<std::uint32_t>::max(),
+};
+
 struct Performance
 {
     std::string play_id;
     int audience;
+    // resolved by `PlayCatalog::resolve` (only meaningful with the same catalog)
+    PlayHandle play_handle = PlayHandle::unresolved;
 };
 
 struct Invoice
@@ -24,4 +48,211 @@ struct Invoice
     std::vector<Performance> performances;
 };
 
+// Allocator-aware counterparts of `Performance` and `Invoice` (cf. `std::pmr`)
+// whose strings and vectors all allocate from the memory resource they are constructed with,
+// so that a whole batch of invoices can live in, e.g., a `std::pmr::monotonic_buffer_resource`
+// and be released at once (rather than string by string).
+// They are rendered by `statement` and `statements` into `std::string` only
+// (not in parallel, recording errors, nor into `std::ostream`);
+// with `std::map`, each play ID is copied into a string to look it up, reused per thread
+// so as not to allocate per line (`PlayCatalog` looks them up in place).
+namespace pmr {
+
+struct Performance
+{
+    using allocator_type = std::pmr::polymorphic_allocator<>;
+
+    Performance(std::string_view play_id, int audience, const allocator_type& alloc = {}) :
+        play_id{play_id, alloc},
+        audience{audience}
+    {
+    }
+
+    Performance(const Performance& other) = default;
+    Performance(Performance&& other) = default;
+    Performance(const Performance& other, const allocator_type& alloc) :
+        play_id{other.play_id, alloc},
+        audience{other.audience},
+        play_handle{other.play_handle}
+    {
+    }
+    Performance(Performance&& other, const allocator_type& alloc) :
+        play_id{std::move(other.play_id), alloc},
+        audience{other.audience},
+        play_handle{other.play_handle}
+    {
+    }
+
+    Performance& operator=(const Performance& other) = default;
+    Performance& operator=(Performance&& other) = default;
+
+    std::pmr::string play_id;
+    int audience;
+    // resolved by `PlayCatalog::resolve` (only meaningful with the same catalog)
+    PlayHandle play_handle = PlayHandle::unresolved;
+};
+
+struct Invoice
+{
+    using allocator_type = std::pmr::polymorphic_allocator<>;
+
+    explicit Invoice(const allocator_type& alloc = {}) :
+        customer{alloc},
+        performances{alloc}
+    {
+    }
+    explicit Invoice(std::string_view customer, const allocator_type& alloc = {}) :
+        customer{customer, alloc},
+        performances{alloc}
+    {
+    }
+
+    Invoice(const Invoice& other) = default;
+    Invoice(Invoice&& other) = default;
+    Invoice(const Invoice& other, const allocator_type& alloc) :
+        customer{other.customer, alloc},
+        performances{other.performances, alloc}
+    {
+    }
+    Invoice(Invoice&& other, const allocator_type& alloc) :
+        customer{std::move(other.customer), alloc},
+        performances{std::move(other.performances), alloc}
+    {
+    }
+
+    Invoice& operator=(const Invoice& other) = default;
+    Invoice& operator=(Invoice&& other) = default;
+
+    std::pmr::string customer;
+    std::pmr::vector<Performance> performances;
+};
+
+}
+
+// Non-owning counterparts of `Performance` and `Invoice` referring to the strings and
+// the performances that live elsewhere (e.g., in a buffer received from the network),
+// which must outlive the views, so that no strings are materialized to render statements
+struct PerformanceView
+{
+    std::string_view play_id;
+    int audience;
+    // resolved by `PlayCatalog::handle_for` (only meaningful with the same catalog)
+    PlayHandle play_handle = PlayHandle::unresolved;
+};
+
+struct InvoiceView
+{
+    std::string_view customer;
+    std::span<const PerformanceView> performances;
+};
+
+class LineCache;
+class PlayCatalog;
+
+// The following are compiled for the plays in `std::map`, `PlayCatalog`, or `PlayHashMap`
+// (or some of them) only, as are `make_statement_data`, `customer_statements`, and
+// `run_statement_pipeline`; any other `PlayLookup` (e.g., a user-defined one) is taken
+// only by the templates of `statement` and `statements` into `std::string` or `std::ostream`
+// in render_statement.h, not recording errors nor in parallel.
+
+// Returns the statement for `invoice`, allocating no more than once (for the text returned,
+// reserved up front) unless the names are long enough to outgrow the reservation.
 std::string statement(const Invoice& invoice, const std::map<std::string, Play>& plays);
+std::string statement(const Invoice& invoice, const PlayCatalog& plays);
+std::string statement(const Invoice& invoice, const PlayHashMap& plays);
+std::string statement(const pmr::Invoice& invoice, const std::map<std::string, Play>& plays);
+std::string statement(const pmr::Invoice& invoice, const PlayCatalog& plays);
+std::string statement(const pmr::Invoice& invoice, const PlayHashMap& plays);
+std::string statement(const InvoiceView& invoice, const std::map<std::string, Play>& plays);
+std::string statement(const InvoiceView& invoice, const PlayCatalog& plays);
+std::string statement(const InvoiceView& invoice, const PlayHashMap& plays);
+
+// Appends the statements for `invoices` to `out` one after another,
+// which is equivalent to but cheaper than concatenating `statement` for each invoice
+// (and reusing `out` across batches saves allocations further).
+void statements(
+    std::span<const Invoice> invoices, const std::map<std::string, Play>& plays, std::string& out);
+void statements(std::span<const Invoice> invoices, const PlayCatalog& plays, std::string& out);
+void statements(std::span<const Invoice> invoices, const PlayHashMap& plays, std::string& out);
+void statements(
+    std::span<const pmr::Invoice> invoices, const std::map<std::string, Play>& plays, std::string& out);
+void statements(std::span<const pmr::Invoice> invoices, const PlayCatalog& plays, std::string& out);
+void statements(std::span<const pmr::Invoice> invoices, const PlayHashMap& plays, std::string& out);
+void statements(
+    std::span<const InvoiceView> invoices, const std::map<std::string, Play>& plays, std::string& out);
+void statements(std::span<const InvoiceView> invoices, const PlayCatalog& plays, std::string& out);
+void statements(std::span<const InvoiceView> invoices, const PlayHashMap& plays, std::string& out);
+
+// Failure to render the statement for an invoice, recorded (rather than thrown) by `statements`
+struct StatementError
+{
+    enum class Code
+    {
+        unknown_play_id,
+        invalid_play_handle,
+        unknown_type,
+        // the total amount beyond `Money`
+        overflow,
+    };
+
+    Code code;
+    // indices of the invoice and its (first) performance in error
+    // (the latter not meaningful for `Code::overflow`)
+    std::size_t invoice;
+    std::size_t performance;
+    // type of the play (only meaningful for `Code::unknown_type`)
+    Play::Type type;
+};
+
+// Returns the message describing `error` (e.g., "macbeth: unknown play ID"),
+// where `invoices` are those for which `error` has been recorded.
+std::string message(const StatementError& error, std::span<const Invoice> invoices);
+
+// Does the same as `statements` into `std::string` except that the invoices whose plays are
+// unknown or of an unknown `Play::Type` (or whose total amounts overflow) are skipped
+// with their errors appended to `errors` rather than thrown, without the cost of exceptions,
+// so that a bad invoice in a batch does not spoil the rest;
+// `out` is left without any part of the skipped statements.
+void statements(
+    std::span<const Invoice> invoices, const std::map<std::string, Play>& plays, std::string& out,
+    std::vector<StatementError>& errors);
+void statements(
+    std::span<const Invoice> invoices, const PlayCatalog& plays, std::string& out,
+    std::vector<StatementError>& errors);
+void statements(
+    std::span<const Invoice> invoices, const PlayHashMap& plays, std::string& out,
+    std::vector<StatementError>& errors);
+
+// Writes the statements for `invoices` to `os` line by line as they are rendered,
+// never holding a whole statement in memory;
+// if rendering fails, `os` is left with the output written so far.
+// (See `FdStreamBuf` for writing to a file descriptor.)
+void statements(
+    std::span<const Invoice> invoices, const std::map<std::string, Play>& plays, std::ostream& os);
+void statements(std::span<const Invoice> invoices, const PlayCatalog& plays, std::ostream& os);
+void statements(std::span<const Invoice> invoices, const PlayHashMap& plays, std::ostream& os);
+
+// Does the same as `statements` into `std::string` but renders the invoices in parallel
+// on all the hardware threads, producing exactly the same output;
+// the lines of a large invoice are split among the threads as well (so that a few
+// large invoices in a batch of small ones do not leave the other threads idle).
+// If rendering fails, rethrows the exception for the earliest failed invoice leaving `out` intact.
+void statements(
+    const std::execution::parallel_policy& policy,
+    std::span<const Invoice> invoices, const std::map<std::string, Play>& plays, std::string& out);
+void statements(
+    const std::execution::parallel_policy& policy,
+    std::span<const Invoice> invoices, const PlayCatalog& plays, std::string& out);
+void statements(
+    const std::execution::parallel_policy& policy,
+    std::span<const Invoice> invoices, const PlayHashMap& plays, std::string& out);
+
+// Do the same as `statements` with `PlayCatalog` into `std::string` (in parallel or not)
+// but look up each line in `cache` first, rendering (and caching) only those not found;
+// `cache` shall be shared only among the renderings with the same `plays`
+// (and takes `PlayCatalog` only as it keys the lines by `PlayHandle`).
+void statements(
+    std::span<const Invoice> invoices, const PlayCatalog& plays, LineCache& cache, std::string& out);
+void statements(
+    const std::execution::parallel_policy& policy,
+    std::span<const Invoice> invoices, const PlayCatalog& plays, LineCache& cache, std::string& out);
@@ -0,0 +1,262 @@
+#include "pch.h"
+
+#include "statement.h"
+
+#include "alloc_check.h"
+#include "money.h"
+#include "play_catalog.h"
+#include "synthetic_data.h"
+
+#include <benchmark/benchmark.h>
+
+namespace {
+
+// Catalog of `size` plays with IDs "play0", "play1", ..., alternating tragedies and comedies
+std::map<std::string, Play> make_plays(int size)
+{
+    std::map<std::string, Play> plays;
+    for (int i = 0; i < size; ++i) {
+        plays.try_emplace(
+            std::format("play{}"sv, i),
+            Play{
+                .name = std::format("Play #{}"sv, i),
+                .type = i % 2 == 0 ? Play::Type::Tragedy : Play::Type::Comedy
+            });
+    }
+    return plays;
+}
+
+// Invoice of `size` performances of plays picked from `plays` at random (but reproducibly)
+Invoice make_invoice(int size, const std::map<std::string, Play>& plays)
+{
+    std::mt19937 gen{42};
+    std::uniform_int_distribution<int> play_dist{0, static_cast<int>(std::size(plays)) - 1};
+    std::uniform_int_distribution<int> audience_dist{0, 100};
+
+    Invoice invoice{.customer = "BigCo"s, .performances = {}};
+    invoice.performances.reserve(static_cast<std::size_t>(size));
+    for (int i = 0; i < size; ++i) {
+        invoice.performances.push_back({
+            .play_id = std::format("play{}"sv, play_dist(gen)),
+            .audience = audience_dist(gen)
+        });
+    }
+    return invoice;
+}
+
+// Reports invoices per second, time per line (e.g., "250ns"), and the heap allocations and
+// the bytes allocated per iteration (counted by `allocations` constructed right before the loop)
+void set_counters(
+    benchmark::State& state, const AllocationCounter& allocations, std::int64_t invoices, std::int64_t lines)
+{
+    const auto stats = allocations.stats();
+    state.counters["allocs"] = benchmark::Counter(
+        static_cast<double>(stats.allocations), benchmark::Counter::kAvgIterations);
+    state.counters["bytes"] = benchmark::Counter(
+        static_cast<double>(stats.bytes), benchmark::Counter::kAvgIterations);
+    state.counters["invoices"] = benchmark::Counter(
+        static_cast<double>(invoices), benchmark::Counter::kIsIterationInvariantRate);
+    state.counters["time/line"] = benchmark::Counter(
+        static_cast<double>(lines),
+        benchmark::Counter::kIsIterationInvariantRate | benchmark::Counter::kInvert);
+}
+
+void BM_BigCo(benchmark::State& state)
+{
+    const std::map<std::string, Play> plays{
+        {"hamlet"s, {.name = "Hamlet"s, .type = Play::Type::Tragedy}},
+        {"as-like"s, {.name = "As You Like It"s, .type = Play::Type::Comedy}},
+        {"othello"s, {.name = "Othello"s, .type = Play::Type::Tragedy}},
+    };
+
+    const Invoice invoice{
+        .customer = "BigCo"s,
+        .performances = {
+            {.play_id = "hamlet"s, .audience = 55},
+            {.play_id = "as-like"s, .audience = 35},
+            {.play_id = "othello"s, .audience = 40},
+        }
+    };
+
+    const AllocationCounter allocations;
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(statement(invoice, plays));
+    }
+    set_counters(state, allocations, 1, std::ssize(invoice.performances));
+}
+BENCHMARK(BM_BigCo);
+
+// Args: number of performances
+void BM_Performances(benchmark::State& state)
+{
+    const auto plays = make_plays(100);
+    const auto invoice = make_invoice(static_cast<int>(state.range(0)), plays);
+
+    const AllocationCounter allocations;
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(statement(invoice, plays));
+    }
+    set_counters(state, allocations, 1, state.range(0));
+}
+BENCHMARK(BM_Performances)->Arg(10)->Arg(1'000)->Arg(100'000);
+
+// Args: number of plays in the catalog
+void BM_CatalogMap(benchmark::State& state)
+{
+    const auto plays = make_plays(static_cast<int>(state.range(0)));
+    const auto invoice = make_invoice(1'000, plays);
+
+    const AllocationCounter allocations;
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(statement(invoice, plays));
+    }
+    set_counters(state, allocations, 1, std::ssize(invoice.performances));
+}
+BENCHMARK(BM_CatalogMap)->Arg(10)->Arg(1'000)->Arg(40'000);
+
+// Args: number of plays in the catalog
+void BM_CatalogHashMap(benchmark::State& state)
+{
+    const auto plays = make_plays(static_cast<int>(state.range(0)));
+    const PlayHashMap hashed_plays{std::cbegin(plays), std::cend(plays)};
+    const auto invoice = make_invoice(1'000, plays);
+
+    const AllocationCounter allocations;
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(statement(invoice, hashed_plays));
+    }
+    set_counters(state, allocations, 1, std::ssize(invoice.performances));
+}
+BENCHMARK(BM_CatalogHashMap)->Arg(10)->Arg(1'000)->Arg(40'000);
+
+// Args: number of plays in the catalog
+void BM_CatalogResolved(benchmark::State& state)
+{
+    const auto plays = make_plays(static_cast<int>(state.range(0)));
+    const PlayCatalog catalog{plays};
+    auto invoice = make_invoice(1'000, plays);
+    catalog.resolve(invoice);
+
+    const AllocationCounter allocations;
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(statement(invoice, catalog));
+    }
+    set_counters(state, allocations, 1, std::ssize(invoice.performances));
+}
+BENCHMARK(BM_CatalogResolved)->Arg(10)->Arg(1'000)->Arg(40'000);
+
+// Args: number of invoices (of 10 performances each)
+void BM_Statements(benchmark::State& state)
+{
+    const auto plays = make_plays(100);
+    const std::vector<Invoice> invoices(static_cast<std::size_t>(state.range(0)), make_invoice(10, plays));
+
+    std::string out;
+    const AllocationCounter allocations;
+    for (auto _ : state) {
+        out.clear();
+        statements(invoices, plays, out);
+        benchmark::DoNotOptimize(out);
+    }
+    set_counters(state, allocations, state.range(0), 10 * state.range(0));
+}
+BENCHMARK(BM_Statements)->Arg(10'000);
+
+// Args: number of invoices (of 10 performances each)
+void BM_StatementsParallel(benchmark::State& state)
+{
+    const auto plays = make_plays(100);
+    const std::vector<Invoice> invoices(static_cast<std::size_t>(state.range(0)), make_invoice(10, plays));
+
+    std::string out;
+    const AllocationCounter allocations;
+    for (auto _ : state) {
+        out.clear();
+        statements(std::execution::par, invoices, plays, out);
+        benchmark::DoNotOptimize(out);
+    }
+    set_counters(state, allocations, state.range(0), 10 * state.range(0));
+}
+BENCHMARK(BM_StatementsParallel)->Arg(10'000)->UseRealTime();
+
+// Args: number of invoices (of 1 to 20 performances each, of 100 customers)
+void BM_Synthetic(benchmark::State& state)
+{
+    const auto [plays, invoices] = make_synthetic_data({.num_invoices = static_cast<std::size_t>(state.range(0))});
+    const PlayCatalog catalog{plays};
+    std::int64_t lines = 0;
+    for (const auto& invoice : invoices) { lines += std::ssize(invoice.performances); }
+
+    std::string out;
+    const AllocationCounter allocations;
+    for (auto _ : state) {
+        out.clear();
+        statements(invoices, catalog, out);
+        benchmark::DoNotOptimize(out);
+    }
+    set_counters(state, allocations, state.range(0), lines);
+}
+BENCHMARK(BM_Synthetic)->Arg(10'000);
+
+// Returns whether en_US.UTF-8 is installed, skipping `state` with an error otherwise
+// (rather than aborting the whole run).
+bool en_us_installed(benchmark::State& state)
+{
+    try {
+        static_cast<void>(std::locale{"en_US.UTF-8"s});
+        return true;
+    }
+    catch (const std::runtime_error&) {
+        state.SkipWithError("en_US.UTF-8 is not installed");
+        return false;
+    }
+}
+
+void BM_MoneyFormatter(benchmark::State& state)
+{
+    if (!en_us_installed(state)) { return; }
+    const MoneyFormatter formatter{std::locale{"en_US.UTF-8"s}};
+
+    std::array<char, 64> buffer;
+    std::int64_t units = 0;
+    for (auto _ : state) {
+        const auto result = formatter.to_chars(std::begin(buffer), std::end(buffer), units);
+        benchmark::DoNotOptimize(result);
+        benchmark::ClobberMemory();
+        units = (units + 12345) % 10'000'000;
+    }
+    state.SetItemsProcessed(static_cast<std::int64_t>(state.iterations()));
+}
+BENCHMARK(BM_MoneyFormatter);
+
+void BM_UsdToChars(benchmark::State& state)
+{
+    std::array<char, usd_max_size> buffer;
+    std::int64_t units = 0;
+    for (auto _ : state) {
+        const auto result = usd_to_chars(std::begin(buffer), std::end(buffer), units);
+        benchmark::DoNotOptimize(result);
+        benchmark::ClobberMemory();
+        units = (units + 12345) % 10'000'000;
+    }
+    state.SetItemsProcessed(static_cast<std::int64_t>(state.iterations()));
+}
+BENCHMARK(BM_UsdToChars);
+
+void BM_PutMoney(benchmark::State& state)
+{
+    // for comparison, what `usd` used to do for every line
+    if (!en_us_installed(state)) { return; }
+    std::int64_t units = 0;
+    for (auto _ : state) {
+        std::ostringstream oss;
+        oss.imbue(std::locale{"en_US.UTF-8"s});
+        oss << std::showbase << std::put_money(static_cast<long double>(units));
+        benchmark::DoNotOptimize(std::move(oss).str());
+        units = (units + 12345) % 10'000'000;
+    }
+    state.SetItemsProcessed(static_cast<std::int64_t>(state.iterations()));
+}
+BENCHMARK(BM_PutMoney);
+
+}
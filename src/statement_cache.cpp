@@ -0,0 +1,251 @@
+#include "pch.h"
+
+#include "statement_cache.h"
+
+namespace {
+
+// to be bumped whenever the text of statements (or the files) changes
+// so as not to read stale ones from disk
+constexpr std::uint32_t format_version = 2;
+
+// byte by byte from the least significant (as `ContentHash` adds them)
+// so that the keys on disk are the same whatever the byte order of the platform
+template<std::integral T>
+void append_to(std::string& out, T value)
+{
+    auto bits = static_cast<std::make_unsigned_t<T>>(value);
+    for (std::size_t i = 0; i < sizeof(T); ++i) {
+        out += static_cast<char>(bits & 0xFF);
+        bits = static_cast<decltype(bits)>(bits >> 8);
+    }
+}
+
+void append_to(std::string& out, std::string_view s)
+{
+    append_to(out, static_cast<std::uint64_t>(std::size(s)));
+    out += s;
+}
+
+// Returns what the statement of `invoice` for `plays` is keyed by,
+// each string prefixed by its length so that different contents never make the same bytes.
+template<typename AnyInvoice>
+std::string contents_of(const AnyInvoice& invoice, const PlayCatalog& plays)
+{
+    std::string contents;
+    append_to(contents, format_version);
+    append_to(contents, plays.fingerprint());
+    append_to(contents, std::string_view{invoice.customer});
+    append_to(contents, static_cast<std::uint64_t>(std::size(invoice.performances)));
+    for (const auto& perf : invoice.performances) {
+        // by the ID so that resolved and unresolved performances share the key
+        append_to(contents, std::string_view{plays.id(plays.handle_for(perf))});
+        append_to(contents, perf.audience);
+    }
+    return contents;
+}
+
+bool is_statement_file(const std::filesystem::directory_entry& entry)
+{
+    std::error_code ignored;
+    return entry.is_regular_file(ignored) && entry.path().extension() == ".txt"sv;
+}
+
+}
+
+StatementCache::StatementCache(std::size_t capacity) :
+    capacity_{capacity},
+    disk_capacity_{0}
+{
+    if (capacity == 0) { throw std::invalid_argument{"zero statement cache capacity"s}; }
+}
+
+StatementCache::StatementCache(
+    std::size_t capacity, std::filesystem::path directory, std::size_t disk_capacity) :
+    capacity_{capacity},
+    directory_{std::move(directory)},
+    disk_capacity_{disk_capacity}
+{
+    if (capacity == 0) { throw std::invalid_argument{"zero statement cache capacity"s}; }
+    if (disk_capacity == 0) { throw std::invalid_argument{"zero statement cache disk capacity"s}; }
+    std::filesystem::create_directories(directory_);
+    disk_size_ = static_cast<std::size_t>(std::ranges::count_if(
+        std::filesystem::directory_iterator{directory_}, is_statement_file));
+}
+
+std::string StatementCache::statement(const Invoice& invoice, const PlayCatalog& plays)
+{
+    return statement_impl(invoice, plays);
+}
+
+std::string StatementCache::statement(const InvoiceView& invoice, const PlayCatalog& plays)
+{
+    return statement_impl(invoice, plays);
+}
+
+template<typename AnyInvoice>
+std::string StatementCache::statement_impl(const AnyInvoice& invoice, const PlayCatalog& plays)
+{
+    auto contents = contents_of(invoice, plays);
+    const auto key = ContentHash{}.add(contents).digest();
+    if (auto text = find(key, contents)) { return std::move(*text); }
+
+    if (auto text = read_file(key, contents)) {
+        insert(key, std::move(contents), *text);
+        const std::lock_guard lock{mutex_};
+        ++disk_hits_;
+        return std::move(*text);
+    }
+
+    auto text = ::statement(invoice, plays);
+    write_file(key, contents, text);
+    insert(key, std::move(contents), text);
+    const std::lock_guard lock{mutex_};
+    ++misses_;
+    return text;
+}
+
+void StatementCache::clear()
+{
+    const std::lock_guard lock{mutex_};
+    index_.clear();
+    entries_.clear();
+}
+
+StatementCache::Stats StatementCache::stats() const
+{
+    const std::lock_guard lock{mutex_};
+    return {
+        .hits = hits_, .disk_hits = disk_hits_, .misses = misses_,
+        .evictions = evictions_, .disk_evictions = disk_evictions_, .size = std::size(entries_),
+    };
+}
+
+std::optional<std::string> StatementCache::find(std::uint64_t key, std::string_view contents)
+{
+    const std::lock_guard lock{mutex_};
+    const auto it = index_.find(key);
+    // a colliding invoice is missed (and replaces the one cached)
+    if (it == std::cend(index_) || it->second->contents != contents) { return std::nullopt; }
+    entries_.splice(std::begin(entries_), entries_, it->second);
+    ++hits_;
+    return it->second->text;
+}
+
+void StatementCache::insert(std::uint64_t key, std::string contents, std::string text)
+{
+    const std::lock_guard lock{mutex_};
+    if (const auto it = index_.find(key); it != std::cend(index_)) {
+        if (it->second->contents != contents) {
+            entries_.splice(std::begin(entries_), entries_, it->second);
+            it->second->contents = std::move(contents);
+            it->second->text = std::move(text);
+        }
+        return;
+    }
+    if (std::size(entries_) < capacity_) {
+        entries_.push_front({.key = key, .contents = std::move(contents), .text = std::move(text)});
+        try {
+            index_.emplace(key, std::begin(entries_));
+        }
+        catch (...) {
+            entries_.pop_front();
+            throw;
+        }
+    }
+    else {
+        // evict the least recently used to reuse its nodes
+        auto node = index_.extract(entries_.back().key);
+        entries_.splice(std::begin(entries_), entries_, std::prev(std::end(entries_)));
+        entries_.front() = {.key = key, .contents = std::move(contents), .text = std::move(text)};
+        node.key() = key;
+        index_.insert(std::move(node));
+        ++evictions_;
+    }
+}
+
+std::optional<std::string> StatementCache::read_file(std::uint64_t key, std::string_view contents) const
+{
+    if (directory_.empty()) { return std::nullopt; }
+    const auto path = path_of(key);
+    std::ifstream ifs{path, std::ios_base::binary};
+    if (!ifs) { return std::nullopt; }
+    // the contents followed by the text
+    std::string text{std::istreambuf_iterator<char>{ifs}, std::istreambuf_iterator<char>{}};
+    if (ifs.bad() || !text.starts_with(contents)) { return std::nullopt; }
+    text.erase(0, std::size(contents));
+
+    // as recently used
+    std::error_code ignored;
+    std::filesystem::last_write_time(path, std::filesystem::file_time_type::clock::now(), ignored);
+    return text;
+}
+
+void StatementCache::write_file(std::uint64_t key, std::string_view contents, std::string_view text)
+{
+    if (directory_.empty()) { return; }
+    // write it aside and rename it into place so that no reader (of any process)
+    // ever sees it partially written
+    thread_local std::mt19937_64 random{std::random_device{}()};
+    const auto path = path_of(key);
+    auto temp_path = path;
+    temp_path += std::format(".{:016x}.tmp"sv, random());
+    {
+        std::ofstream ofs{temp_path, std::ios_base::binary | std::ios_base::trunc};
+        ofs.write(std::data(contents), static_cast<std::streamsize>(std::size(contents)));
+        ofs.write(std::data(text), static_cast<std::streamsize>(std::size(text)));
+        ofs.close();
+        if (!ofs) {
+            std::error_code ignored;
+            std::filesystem::remove(temp_path, ignored);
+            return;
+        }
+    }
+    std::error_code error;
+    const auto replaced = std::filesystem::exists(path, error);
+    std::filesystem::rename(temp_path, path, error);
+    if (error) {
+        std::filesystem::remove(temp_path, error);
+        return;
+    }
+    if (replaced) { return; }
+
+    bool full = false;
+    {
+        const std::lock_guard lock{mutex_};
+        full = ++disk_size_ > disk_capacity_;
+    }
+    if (full) { evict_files(path); }
+}
+
+void StatementCache::evict_files(const std::filesystem::path& kept)
+{
+    std::vector<std::pair<std::filesystem::file_time_type, std::filesystem::path>> files;
+    std::error_code error;
+    for (std::filesystem::directory_iterator it{directory_, error}, end;
+         !error && it != end; it.increment(error)) {
+        if (!is_statement_file(*it) || it->path() == kept) { continue; }
+        std::error_code time_error;
+        const auto time = it->last_write_time(time_error);
+        if (!time_error) { files.emplace_back(time, it->path()); }
+    }
+
+    // the least recently used first down to seven eighths of the capacity (but `kept`)
+    const auto target = disk_capacity_ - disk_capacity_ / 8;
+    const auto total = std::size(files) + 1;
+    const auto removed = total > target ? std::min(total - target, std::size(files)) : std::size_t{0};
+    std::ranges::partial_sort(files, std::begin(files) + static_cast<std::ptrdiff_t>(removed));
+    std::uint64_t evictions = 0;
+    for (const auto& [time, path] : files | std::views::take(removed)) {
+        std::error_code ignored;
+        if (std::filesystem::remove(path, ignored)) { ++evictions; }
+    }
+
+    const std::lock_guard lock{mutex_};
+    disk_size_ = total - evictions;
+    disk_evictions_ += evictions;
+}
+
+std::filesystem::path StatementCache::path_of(std::uint64_t key) const
+{
+    return directory_ / std::format("{:016x}.txt"sv, key);
+}
@@ -0,0 +1,85 @@
+#pragma once
+
+#include "play_catalog.h"
+
+// Cache of rendered statements in front of `statement` keyed by the hash of the contents of
+// the invoice and the fingerprint of the catalog (see `PlayCatalog::fingerprint`),
+// so that changing the catalog invalidates the entries rendered with it for nothing
+// (they are no longer looked up and age out) and any catalog of the same plays reuses them.
+// The least recently used of up to `capacity` statements are kept in memory and,
+// given a directory, those of up to `disk_capacity` statements on disk as well
+// (one file per statement, the least recently read or written removed) to outlive the process;
+// the disk tier is best effort, i.e., failing to read or write it only makes a miss.
+// It can be shared among threads; a statement missed by several at once is rendered by each.
+// Each statement is kept with the contents it is keyed by (the customer and the plays and
+// audiences of the performances), compared on a hit so that colliding invoices make a miss
+// rather than share one.
+class StatementCache
+{
+public:
+    struct Stats
+    {
+        std::uint64_t hits;
+        // hits on disk after missing in memory (not counted in `hits`)
+        std::uint64_t disk_hits;
+        std::uint64_t misses;
+        // statements dropped from memory to make room
+        std::uint64_t evictions;
+        // statements removed from disk to make room
+        std::uint64_t disk_evictions;
+        std::size_t size;
+    };
+
+    // Holds up to `capacity` statements in memory, and up to `disk_capacity` on disk
+    // in `directory` (created if missing); throws `std::invalid_argument` if either capacity is zero
+    // and `std::filesystem::filesystem_error` if `directory` cannot be created.
+    // Once over `disk_capacity` (counting the statements already in `directory`),
+    // the least recently used eighth of them is removed at once not to scan `directory` for each.
+    explicit StatementCache(std::size_t capacity);
+    StatementCache(std::size_t capacity, std::filesystem::path directory, std::size_t disk_capacity);
+
+    // Returns the statement of `invoice` for `plays`, rendering it (and caching it) if not cached;
+    // throws what `statement` throws (caching nothing).
+    std::string statement(const Invoice& invoice, const PlayCatalog& plays);
+    std::string statement(const InvoiceView& invoice, const PlayCatalog& plays);
+
+    // Drops all the statements in memory (but not on disk).
+    void clear();
+
+    Stats stats() const;
+
+private:
+    struct Entry
+    {
+        std::uint64_t key;
+        // what `key` is the hash of
+        std::string contents;
+        std::string text;
+    };
+
+    template<typename AnyInvoice>
+    std::string statement_impl(const AnyInvoice& invoice, const PlayCatalog& plays);
+
+    std::optional<std::string> find(std::uint64_t key, std::string_view contents);
+    void insert(std::uint64_t key, std::string contents, std::string text);
+    std::optional<std::string> read_file(std::uint64_t key, std::string_view contents) const;
+    void write_file(std::uint64_t key, std::string_view contents, std::string_view text);
+    void evict_files(const std::filesystem::path& kept);
+    std::filesystem::path path_of(std::uint64_t key) const;
+
+    std::size_t capacity_;
+    std::filesystem::path directory_;
+    std::size_t disk_capacity_;
+
+    mutable std::mutex mutex_;
+    // most recently used first
+    std::list<Entry> entries_;
+    std::unordered_map<std::uint64_t, std::list<Entry>::iterator> index_;
+    std::uint64_t hits_ = 0;
+    std::uint64_t disk_hits_ = 0;
+    std::uint64_t misses_ = 0;
+    std::uint64_t evictions_ = 0;
+    std::uint64_t disk_evictions_ = 0;
+    // statements on disk as far as known (others may be written or removed by other processes)
+    std::size_t disk_size_ = 0;
+};
@@ -0,0 +1,222 @@
+#include "pch.h"
+
+#include "statement_cache.h"
+
+#include <gtest/gtest.h>
+#include <gmock/gmock.h>
+
+using namespace testing;
+
+namespace {
+
+const std::map<std::string, Play> plays{
+    {"hamlet"s, {.name = "Hamlet"s, .type = Play::Type::Tragedy}},
+    {"as-like"s, {.name = "As You Like It"s, .type = Play::Type::Comedy}},
+    {"othello"s, {.name = "Othello"s, .type = Play::Type::Tragedy}},
+};
+
+const Invoice invoice{
+    .customer = "BigCo"s,
+    .performances = {
+        {.play_id = "hamlet"s, .audience = 55},
+        {.play_id = "as-like"s, .audience = 35},
+        {.play_id = "othello"s, .audience = 40},
+    },
+};
+
+TEST(ContentHashTest, Digest)
+{
+    // FNV-1a of no bytes and of "a"
+    EXPECT_EQ(ContentHash{}.digest(), 0xCBF29CE484222325ull);
+    EXPECT_EQ(ContentHash{}.add('a').digest(), 0xAF63DC4C8601EC8Cull);
+
+    const auto digest = ContentHash{}.add("ab"sv).add(1).digest();
+    EXPECT_EQ(ContentHash{}.add("ab"s).add(1).digest(), digest);
+    EXPECT_EQ(ContentHash{ContentHash{}.add("ab"sv).digest()}.add(1).digest(), digest);
+    EXPECT_NE(ContentHash{}.add("a"sv).add("b"sv).add(1).digest(), digest);
+    EXPECT_NE(ContentHash{}.add("ab"sv).add(1ll).digest(), digest);
+}
+
+TEST(StatementCacheTest, Memory)
+{
+    const PlayCatalog catalog{plays};
+    StatementCache cache{10};
+    const auto expected = statement(invoice, catalog);
+
+    EXPECT_EQ(cache.statement(invoice, catalog), expected);
+    EXPECT_EQ(cache.statement(invoice, catalog), expected);
+
+    // the same contents whether resolved or viewed
+    auto resolved = invoice;
+    catalog.resolve(resolved);
+    EXPECT_EQ(cache.statement(resolved, catalog), expected);
+    const std::vector<PerformanceView> perfs{{"hamlet"sv, 55}, {"as-like"sv, 35}, {"othello"sv, 40}};
+    EXPECT_EQ(cache.statement(InvoiceView{.customer = "BigCo"sv, .performances = perfs}, catalog), expected);
+
+    auto other = invoice;
+    other.performances[1].audience = 36;
+    EXPECT_EQ(cache.statement(other, catalog), statement(other, catalog));
+
+    auto stats = cache.stats();
+    EXPECT_EQ(stats.hits, 3);
+    EXPECT_EQ(stats.disk_hits, 0);
+    EXPECT_EQ(stats.misses, 2);
+    EXPECT_EQ(stats.evictions, 0);
+    EXPECT_EQ(stats.size, 2);
+
+    cache.clear();
+    EXPECT_EQ(cache.stats().size, 0);
+    EXPECT_EQ(cache.statement(invoice, catalog), expected);
+    EXPECT_EQ(cache.stats().misses, 3);
+
+    const Invoice unknown{.customer = "BigCo"s, .performances = {{.play_id = "macbeth"s, .audience = 1}}};
+    EXPECT_THROW(cache.statement(unknown, catalog), std::out_of_range);
+    EXPECT_EQ(cache.stats().size, 1);
+
+    EXPECT_THROW(StatementCache{0}, std::invalid_argument);
+    EXPECT_THROW((StatementCache{1, std::filesystem::temp_directory_path(), 0}), std::invalid_argument);
+}
+
+TEST(StatementCacheTest, Catalog)
+{
+    PlayCatalog catalog{plays};
+    StatementCache cache{10};
+    const auto fingerprint = catalog.fingerprint();
+    EXPECT_EQ(PlayCatalog{plays}.fingerprint(), fingerprint);
+
+    cache.statement(invoice, catalog);
+    // any catalog of the same plays
+    cache.statement(invoice, PlayCatalog{plays});
+    EXPECT_EQ(cache.stats().hits, 1);
+
+    // adding a play invalidates the statements
+    catalog.add("macbeth"s, {.name = "Macbeth"s, .type = Play::Type::Tragedy});
+    EXPECT_NE(catalog.fingerprint(), fingerprint);
+    cache.statement(invoice, catalog);
+    EXPECT_EQ(cache.stats().misses, 2);
+
+    // and so does renaming one
+    auto renamed = plays;
+    renamed["hamlet"s].name = "Hamlet, Prince of Denmark"s;
+    const PlayCatalog renamed_catalog{renamed};
+    EXPECT_THAT(cache.statement(invoice, renamed_catalog), HasSubstr("Hamlet, Prince of Denmark"s));
+    EXPECT_EQ(cache.stats().misses, 3);
+}
+
+TEST(StatementCacheTest, Evict)
+{
+    const PlayCatalog catalog{plays};
+    StatementCache cache{2};
+    auto invoice_of = [](int audience)
+    {
+        return Invoice{.customer = "BigCo"s, .performances = {{.play_id = "hamlet"s, .audience = audience}}};
+    };
+
+    cache.statement(invoice_of(1), catalog);
+    cache.statement(invoice_of(2), catalog);
+    // the least recently used is 2 once 1 is used again
+    cache.statement(invoice_of(1), catalog);
+    cache.statement(invoice_of(3), catalog);
+    EXPECT_EQ(cache.stats().evictions, 1);
+    EXPECT_EQ(cache.stats().size, 2);
+
+    cache.statement(invoice_of(1), catalog);
+    cache.statement(invoice_of(3), catalog);
+    EXPECT_EQ(cache.stats().hits, 3);
+    EXPECT_EQ(cache.statement(invoice_of(2), catalog), statement(invoice_of(2), catalog));
+    EXPECT_EQ(cache.stats().misses, 4);
+    EXPECT_EQ(cache.stats().evictions, 2);
+}
+
+TEST(StatementCacheTest, Disk)
+{
+    const auto directory = std::filesystem::temp_directory_path() / "statement_cache_test";
+    std::filesystem::remove_all(directory);
+    const PlayCatalog catalog{plays};
+    const auto expected = statement(invoice, catalog);
+
+    {
+        StatementCache cache{1, directory, 10};
+        EXPECT_EQ(cache.statement(invoice, catalog), expected);
+        EXPECT_EQ(std::distance(std::filesystem::directory_iterator{directory}, {}), 1);
+        // named by the key, which is the same on any platform (e.g., whatever its byte order)
+        EXPECT_EQ(std::filesystem::directory_iterator{directory}->path().filename(), "3745a7c3056cb03c.txt"s);
+    }
+    {
+        // as if in another run
+        StatementCache cache{1, directory, 10};
+        EXPECT_EQ(cache.statement(invoice, catalog), expected);
+        EXPECT_EQ(cache.statement(invoice, catalog), expected);
+        const auto stats = cache.stats();
+        EXPECT_EQ(stats.hits, 1);
+        EXPECT_EQ(stats.disk_hits, 1);
+        EXPECT_EQ(stats.misses, 0);
+    }
+
+    std::filesystem::remove_all(directory);
+}
+
+TEST(StatementCacheTest, DiskCollision)
+{
+    const auto directory = std::filesystem::temp_directory_path() / "statement_cache_collision_test";
+    std::filesystem::remove_all(directory);
+    const PlayCatalog catalog{plays};
+    const auto expected = statement(invoice, catalog);
+
+    {
+        StatementCache cache{1, directory, 10};
+        cache.statement(invoice, catalog);
+    }
+    // as if another invoice of the same hash had been written there
+    const auto path = std::filesystem::directory_iterator{directory}->path();
+    std::ofstream{path, std::ios_base::binary | std::ios_base::trunc} << "another invoice"sv;
+    {
+        StatementCache cache{1, directory, 10};
+        EXPECT_EQ(cache.statement(invoice, catalog), expected);
+        EXPECT_EQ(cache.stats().disk_hits, 0);
+        EXPECT_EQ(cache.stats().misses, 1);
+    }
+    {
+        // rewritten
+        StatementCache cache{1, directory, 10};
+        EXPECT_EQ(cache.statement(invoice, catalog), expected);
+        EXPECT_EQ(cache.stats().disk_hits, 1);
+    }
+
+    std::filesystem::remove_all(directory);
+}
+
+TEST(StatementCacheTest, DiskEvict)
+{
+    const auto directory = std::filesystem::temp_directory_path() / "statement_cache_evict_test";
+    std::filesystem::remove_all(directory);
+    const PlayCatalog catalog{plays};
+    auto invoice_of = [](int audience)
+    {
+        return Invoice{.customer = "BigCo"s, .performances = {{.play_id = "hamlet"s, .audience = audience}}};
+    };
+    auto num_files = [&] { return std::distance(std::filesystem::directory_iterator{directory}, {}); };
+
+    {
+        StatementCache cache{1, directory, 8};
+        for (int i = 0; i < 8; ++i) { cache.statement(invoice_of(i), catalog); }
+        EXPECT_EQ(num_files(), 8);
+        EXPECT_EQ(cache.stats().disk_evictions, 0);
+    }
+    {
+        // counting those already there, once over the capacity down to seven eighths of it
+        StatementCache cache{1, directory, 8};
+        cache.statement(invoice_of(8), catalog);
+        EXPECT_EQ(num_files(), 7);
+        EXPECT_EQ(cache.stats().disk_evictions, 2);
+    }
+    {
+        StatementCache cache{2, directory, 8};
+        cache.statement(invoice_of(8), catalog);
+        EXPECT_EQ(cache.stats().disk_hits, 1);
+    }
+
+    std::filesystem::remove_all(directory);
+}
+
+}
@@ -0,0 +1,382 @@
+#include "pch.h"
+
+#include "columnar_invoice.h"
+#include "customer_statements.h"
+#include "incremental_statement.h"
+#include "line_cache.h"
+#include "play_catalog.h"
+#include "statement_cache.h"
+#include "statement_renderers.h"
+#include "streaming_statement.h"
+#include "synthetic_data.h"
+
+#include <gtest/gtest.h>
+#include <gmock/gmock.h>
+
+using namespace testing;
+
+// Checks each path of rendering statements against the reference over synthetic invoices
+// of various shapes: the original algorithm of Fowler (2018), kept here deliberately naive
+// and apart from the code under test (e.g., `Usd` and `PricingRule`)
+// so that a bug shared among the paths still shows up as a difference.
+
+namespace {
+
+// Returns `cents` as USD in en_US (e.g., "$1,730.00"), formatted digit by digit
+// (rather than by `std::put_money` so as not to depend on the locales installed).
+std::string naive_usd(std::int64_t cents)
+{
+    auto digits = std::to_string(cents < 0 ? -cents : cents);
+    if (std::size(digits) < 3) { digits.insert(0, 3 - std::size(digits), '0'); }
+    auto units = digits.substr(0, std::size(digits) - 2);
+    for (auto i = std::size(units); i > 3; i -= 3) { units.insert(i - 3, 1, ','); }
+    return (cents < 0 ? "-$"s : "$"s) + units + "." + digits.substr(std::size(digits) - 2);
+}
+
+std::int64_t naive_amount(Play::Type type, int audience)
+{
+    std::int64_t amount = 0;
+    switch (type) {
+    case Play::Type::Tragedy:
+        amount = 40000;
+        if (audience > 30) {
+            amount += 1000 * std::int64_t{audience - 30};
+        }
+        break;
+    case Play::Type::Comedy:
+        amount = 30000;
+        if (audience > 20) {
+            amount += 10000 + 500 * std::int64_t{audience - 20};
+        }
+        amount += 300 * std::int64_t{audience};
+        break;
+    default:
+        throw std::runtime_error{"unknown Play::Type"s};
+    }
+    return amount;
+}
+
+std::int64_t naive_volume_credits(Play::Type type, int audience)
+{
+    std::int64_t volume_credits = std::max(audience - 30, 0);
+    // add extra credit for every ten comedy attendees
+    if (Play::Type::Comedy == type) { volume_credits += audience / 5; }
+    return volume_credits;
+}
+
+// Returns the statement for `invoice` as the original algorithm did (though in 64 bits).
+std::string naive_statement(const Invoice& invoice, const std::map<std::string, Play>& plays)
+{
+    std::int64_t total_amount = 0;
+    std::int64_t volume_credits = 0;
+    std::string result = "Statement for " + invoice.customer + "\n";
+
+    for (const auto& perf : invoice.performances) {
+        const auto& play = plays.at(perf.play_id);
+        const auto this_amount = naive_amount(play.type, perf.audience);
+        volume_credits += naive_volume_credits(play.type, perf.audience);
+
+        // print line for this order
+        result += "  " + play.name + ": " + naive_usd(this_amount) +
+            " (" + std::to_string(perf.audience) + " seats)\n";
+        total_amount += this_amount;
+    }
+
+    result += "Amount owed is " + naive_usd(total_amount) + "\n";
+    result += "You earned " + std::to_string(volume_credits) + " credits\n";
+    return result;
+}
+
+struct Workload
+{
+    std::string_view name;
+    SyntheticOptions options;
+};
+
+const auto workloads = std::to_array<Workload>({
+    {.name = "small"sv, .options = {.num_plays = 10, .num_customers = 20, .num_invoices = 100}},
+    {
+        .name = "comedies"sv,
+        .options = {
+            .num_plays = 50, .num_invoices = 100, .max_audience = 1'000,
+            .genres = {{.type = Play::Type::Comedy, .weight = 1.0}},
+        },
+    },
+    {
+        .name = "large invoices"sv,
+        .options = {
+            .num_plays = 1'000, .num_customers = 3, .num_invoices = 8,
+            .min_performances = 500, .max_performances = 3'000, .max_audience = 500,
+        },
+    },
+    {
+        .name = "many tiny invoices"sv,
+        .options = {
+            .num_plays = 5, .num_customers = 1'000, .num_invoices = 5'000,
+            .min_performances = 0, .max_performances = 2, .seed = 7,
+        },
+    },
+});
+
+// Returns the statements of `data` rendered one by one by the reference.
+std::vector<std::string> reference_statements(const SyntheticData& data)
+{
+    std::vector<std::string> texts;
+    for (const auto& invoice : data.invoices) { texts.push_back(naive_statement(invoice, data.plays)); }
+    return texts;
+}
+
+std::string concatenated(std::span<const std::string> texts)
+{
+    std::string out;
+    for (const auto& text : texts) { out += text; }
+    return out;
+}
+
+// The reference itself is checked against the statement known from the book.
+TEST(StatementDifferentialTest, Reference)
+{
+    const std::map<std::string, Play> plays{
+        {"hamlet"s, {.name = "Hamlet"s, .type = Play::Type::Tragedy}},
+        {"as-like"s, {.name = "As You Like It"s, .type = Play::Type::Comedy}},
+        {"othello"s, {.name = "Othello"s, .type = Play::Type::Tragedy}},
+    };
+    const Invoice invoice{
+        .customer = "BigCo"s,
+        .performances = {
+            {.play_id = "hamlet"s, .audience = 55},
+            {.play_id = "as-like"s, .audience = 35},
+            {.play_id = "othello"s, .audience = 40},
+        },
+    };
+
+    EXPECT_EQ(naive_statement(invoice, plays), R"###(Statement for BigCo
+  Hamlet: $650.00 (55 seats)
+  As You Like It: $580.00 (35 seats)
+  Othello: $500.00 (40 seats)
+Amount owed is $1,730.00
+You earned 47 credits
+)###"s);
+
+    EXPECT_EQ(naive_usd(0), "$0.00"s);
+    EXPECT_EQ(naive_usd(5), "$0.05"s);
+    EXPECT_EQ(naive_usd(-5), "-$0.05"s);
+    EXPECT_EQ(naive_usd(100000), "$1,000.00"s);
+    EXPECT_EQ(naive_usd(123456789), "$1,234,567.89"s);
+}
+
+TEST(StatementDifferentialTest, Statement)
+{
+    for (const auto& [name, options] : workloads) {
+        SCOPED_TRACE(name);
+        const auto data = make_synthetic_data(options);
+        const auto expected = reference_statements(data);
+        const PlayCatalog catalog{data.plays};
+        const PlayHashMap hashed_plays{std::cbegin(data.plays), std::cend(data.plays)};
+        const std::array renderers{StatementRenderer{render_text}};
+
+        for (std::size_t i = 0; i < std::size(data.invoices); ++i) {
+            const auto& invoice = data.invoices[i];
+            ASSERT_EQ(statement(invoice, data.plays), expected[i]);
+            ASSERT_EQ(statement(invoice, catalog), expected[i]);
+            ASSERT_EQ(statement(invoice, hashed_plays), expected[i]);
+
+            auto resolved = invoice;
+            catalog.resolve(resolved);
+            ASSERT_EQ(statement(resolved, catalog), expected[i]);
+
+            pmr::Invoice pmr_invoice{invoice.customer};
+            std::vector<PerformanceView> perfs;
+            for (const auto& perf : invoice.performances) {
+                pmr_invoice.performances.emplace_back(perf.play_id, perf.audience);
+                perfs.push_back({.play_id = perf.play_id, .audience = perf.audience});
+            }
+            ASSERT_EQ(statement(pmr_invoice, data.plays), expected[i]);
+            ASSERT_EQ(statement(pmr_invoice, catalog), expected[i]);
+            const InvoiceView view{.customer = invoice.customer, .performances = perfs};
+            ASSERT_EQ(statement(view, data.plays), expected[i]);
+            ASSERT_EQ(statement(view, catalog), expected[i]);
+
+            ASSERT_EQ(render_formats(invoice, catalog, renderers)[0], expected[i]);
+        }
+    }
+}
+
+TEST(StatementDifferentialTest, Statements)
+{
+    for (const auto& [name, options] : workloads) {
+        SCOPED_TRACE(name);
+        const auto data = make_synthetic_data(options);
+        const auto expected = concatenated(reference_statements(data));
+        const PlayCatalog catalog{data.plays};
+        const PlayHashMap hashed_plays{std::cbegin(data.plays), std::cend(data.plays)};
+
+        const auto check = [&](auto render)
+        {
+            std::string out;
+            render(out);
+            EXPECT_EQ(out, expected);
+        };
+        check([&](std::string& out) { statements(data.invoices, data.plays, out); });
+        check([&](std::string& out) { statements(data.invoices, catalog, out); });
+        check([&](std::string& out) { statements(data.invoices, hashed_plays, out); });
+        check([&](std::string& out)
+        {
+            std::vector<StatementError> errors;
+            statements(data.invoices, catalog, out, errors);
+            EXPECT_THAT(errors, IsEmpty());
+        });
+        check([&](std::string& out)
+        {
+            std::ostringstream oss;
+            statements(data.invoices, catalog, oss);
+            out = std::move(oss).str();
+        });
+    }
+}
+
+TEST(StatementDifferentialTest, Parallel)
+{
+    for (const auto& [name, options] : workloads) {
+        SCOPED_TRACE(name);
+        const auto data = make_synthetic_data(options);
+        const auto expected = concatenated(reference_statements(data));
+        const PlayCatalog catalog{data.plays};
+
+        std::string out;
+        statements(std::execution::par, data.invoices, data.plays, out);
+        EXPECT_EQ(out, expected);
+        out.clear();
+        statements(std::execution::par, data.invoices, catalog, out);
+        EXPECT_EQ(out, expected);
+    }
+}
+
+TEST(StatementDifferentialTest, Cached)
+{
+    for (const auto& [name, options] : workloads) {
+        SCOPED_TRACE(name);
+        const auto data = make_synthetic_data(options);
+        const auto texts = reference_statements(data);
+        const auto expected = concatenated(texts);
+        const PlayCatalog catalog{data.plays};
+
+        // cold and then warm
+        LineCache line_cache{1'000};
+        for (int pass = 0; pass < 2; ++pass) {
+            std::string out;
+            statements(data.invoices, catalog, line_cache, out);
+            EXPECT_EQ(out, expected);
+            out.clear();
+            statements(std::execution::par, data.invoices, catalog, line_cache, out);
+            EXPECT_EQ(out, expected);
+        }
+
+        StatementCache statement_cache{std::size(data.invoices) / 2 + 1};
+        for (int pass = 0; pass < 2; ++pass) {
+            for (std::size_t i = 0; i < std::size(data.invoices); ++i) {
+                ASSERT_EQ(statement_cache.statement(data.invoices[i], catalog), texts[i]);
+            }
+        }
+    }
+}
+
+TEST(StatementDifferentialTest, Streaming)
+{
+    for (const auto& [name, options] : workloads) {
+        SCOPED_TRACE(name);
+        const auto data = make_synthetic_data(options);
+        const auto expected = reference_statements(data);
+        const PlayCatalog catalog{data.plays};
+
+        for (std::size_t i = 0; i < std::size(data.invoices); ++i) {
+            const auto& invoice = data.invoices[i];
+            std::ostringstream oss;
+            StreamingStatement streaming{invoice.customer, catalog, oss};
+            // in chunks of various sizes
+            std::span<const Performance> rest = invoice.performances;
+            for (std::size_t chunk = 1; !rest.empty(); chunk = chunk * 2 + 1) {
+                const auto n = std::min(chunk, std::size(rest));
+                streaming.add(rest.first(n));
+                rest = rest.subspan(n);
+            }
+            streaming.finish();
+            ASSERT_EQ(oss.str(), expected[i]);
+        }
+    }
+}
+
+TEST(StatementDifferentialTest, Incremental)
+{
+    for (const auto& [name, options] : workloads) {
+        SCOPED_TRACE(name);
+        const auto data = make_synthetic_data(options);
+        const auto expected = reference_statements(data);
+        const PlayCatalog catalog{data.plays};
+
+        for (std::size_t i = 0; i < std::size(data.invoices); ++i) {
+            const auto& invoice = data.invoices[i];
+            ASSERT_EQ(IncrementalStatement(invoice, catalog).str(), expected[i]);
+
+            // built up performance by performance
+            IncrementalStatement incremental{Invoice{.customer = invoice.customer, .performances = {}}, catalog};
+            for (const auto& perf : invoice.performances) { incremental.push_back(perf); }
+            ASSERT_EQ(incremental.str(), expected[i]);
+        }
+    }
+}
+
+TEST(StatementDifferentialTest, Customers)
+{
+    for (const auto& [name, options] : workloads) {
+        SCOPED_TRACE(name);
+        const auto data = make_synthetic_data(options);
+        const PlayCatalog catalog{data.plays};
+
+        // the reference for each customer is the statement for all of their performances
+        std::vector<Invoice> merged;
+        std::map<std::string_view, std::size_t> indices;
+        for (const auto& invoice : data.invoices) {
+            const auto [it, inserted] = indices.try_emplace(invoice.customer, std::size(merged));
+            if (inserted) { merged.push_back({.customer = invoice.customer, .performances = {}}); }
+            auto& perfs = merged[it->second].performances;
+            perfs.insert(std::cend(perfs), std::cbegin(invoice.performances), std::cend(invoice.performances));
+        }
+
+        for (const auto& results : {
+                customer_statements(data.invoices, data.plays),
+                customer_statements(data.invoices, catalog),
+                customer_statements(std::execution::par, data.invoices, catalog)}) {
+            ASSERT_EQ(std::size(results), std::size(merged));
+            for (std::size_t i = 0; i < std::size(merged); ++i) {
+                ASSERT_EQ(results[i].customer, merged[i].customer);
+                ASSERT_EQ(results[i].text, naive_statement(merged[i], data.plays));
+            }
+        }
+    }
+}
+
+TEST(StatementDifferentialTest, Columnar)
+{
+    for (const auto& [name, options] : workloads) {
+        SCOPED_TRACE(name);
+        const auto data = make_synthetic_data(options);
+        const PlayCatalog catalog{data.plays};
+
+        for (const auto& invoice : data.invoices) {
+            const auto columns = make_columnar_invoice(invoice, catalog);
+            std::vector<std::int64_t> amounts(columns.size());
+            std::vector<std::int64_t> volume_credits(columns.size());
+            price_performances(columns.play_types, columns.audiences, amounts, volume_credits);
+
+            for (std::size_t j = 0; j < columns.size(); ++j) {
+                const auto& perf = invoice.performances[j];
+                const auto type = data.plays.at(perf.play_id).type;
+                ASSERT_EQ(amounts[j], naive_amount(type, perf.audience));
+                ASSERT_EQ(volume_credits[j], naive_volume_credits(type, perf.audience));
+            }
+        }
+    }
+}
+
+}
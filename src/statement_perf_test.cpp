@@ -0,0 +1,358 @@
+#include "pch.h"
+
+#include "alloc_check.h"
+#include "content_hash.h"
+#include "line_cache.h"
+#include "play_catalog.h"
+#include "statement_cache.h"
+#include "synthetic_data.h"
+
+#include <gtest/gtest.h>
+#include <gmock/gmock.h>
+
+using namespace testing;
+
+// Performance regression tests, each of which measures the throughput (statements per second)
+// and the heap allocations and bytes per statement (see `AllocationCounter`)
+// of a path of rendering statements over synthetic invoices and fails if the throughput drops
+// by more than the tolerance (30% or `STATEMENT_PERF_TOLERANCE`) or the allocations (or bytes)
+// rise above the baselines: the throughput in `STATEMENT_PERF_BASELINE` for the same compiler
+// and platform on the machine to check (which it is only meaningful for), recorded with
+// `STATEMENT_PERF_RECORD=1`, and the allocations in `STATEMENT_PERF_ALLOCATIONS` (committed
+// along with the sources) for the same standard library, which they depend on alone,
+// recorded only with `STATEMENT_PERF_RECORD_ALLOCATIONS=1` (or from the figures reported
+// on failure) so that no regression is accepted in passing;
+// fails if no baseline is recorded to check against.
+// The throughput is checked only in optimized builds (with `NDEBUG`), and the allocations
+// only serially as those in parallel grow with `std::thread::hardware_concurrency`.
+
+namespace {
+
+struct Measurement
+{
+    // statements per second relative to the speed of the machine at the moment (see `measure`)
+    double relative_throughput;
+    double allocations_per_statement;
+    double bytes_per_statement;
+};
+
+// Returns the compiler, the platform, and the build type that the throughput is recorded for
+// (e.g., "gcc-13/linux-x86_64/release").
+std::string platform()
+{
+#if defined(__clang__)
+    const auto compiler = std::format("clang-{}"sv, __clang_major__);
+#elif defined(__GNUC__)
+    const auto compiler = std::format("gcc-{}"sv, __GNUC__);
+#elif defined(_MSC_VER)
+    const auto compiler = std::format("msvc-{}"sv, _MSC_VER);
+#else
+    const auto compiler = "unknown"s;
+#endif
+#if defined(_WIN32)
+    constexpr auto os = "windows"sv;
+#elif defined(__APPLE__)
+    constexpr auto os = "macos"sv;
+#elif defined(__linux__)
+    constexpr auto os = "linux"sv;
+#else
+    constexpr auto os = "unknown"sv;
+#endif
+#if defined(__x86_64__) || defined(_M_X64)
+    constexpr auto arch = "x86_64"sv;
+#elif defined(__aarch64__) || defined(_M_ARM64)
+    constexpr auto arch = "arm64"sv;
+#else
+    constexpr auto arch = "unknown"sv;
+#endif
+#ifdef NDEBUG
+    constexpr auto build = "release"sv;
+#else
+    constexpr auto build = "debug"sv;
+#endif
+    return std::format("{}/{}-{}/{}"sv, compiler, os, arch, build);
+}
+
+// Returns the standard library and its major version that the allocations are recorded for
+// (which allocates the same whatever the compiler and the machine), e.g., "libstdc++-13".
+std::string standard_library()
+{
+#if defined(_LIBCPP_VERSION)
+    return std::format("libc++-{}"sv, _LIBCPP_VERSION / 10000);
+#elif defined(__GLIBCXX__)
+    return std::format("libstdc++-{}"sv, _GLIBCXX_RELEASE);
+#elif defined(_MSVC_STL_VERSION)
+    // the checked iterators allocate (e.g., a proxy for each string)
+    return std::format("msvc-stl-{}{}"sv, _MSVC_STL_VERSION, _ITERATOR_DEBUG_LEVEL != 0 ? "-debug"sv : ""sv);
+#else
+    return "unknown"s;
+#endif
+}
+
+// Baseline of `N` figures recorded by the key (e.g., the platform) and the name of each measurement
+template<std::size_t N>
+struct Baseline
+{
+    std::map<std::pair<std::string, std::string>, std::array<double, N>, std::less<>> measurements;
+
+    static Baseline load(const std::filesystem::path& path)
+    {
+        Baseline baseline;
+        std::ifstream ifs{path};
+        for (std::string line; std::getline(ifs, line);) {
+            if (line.empty() || line.front() == '#') { continue; }
+            std::istringstream iss{line};
+            std::string key;
+            std::string name;
+            std::array<double, N> figures{};
+            iss >> key >> name;
+            for (auto& figure : figures) { iss >> figure; }
+            if (iss) { baseline.measurements.insert_or_assign({std::move(key), std::move(name)}, figures); }
+        }
+        return baseline;
+    }
+
+    // Returns the figures recorded for `key` and `name` or null if none.
+    const std::array<double, N>* find(const std::string& key, const std::string& name) const
+    {
+        const auto it = measurements.find(std::pair{key, name});
+        return it != std::cend(measurements) ? &it->second : nullptr;
+    }
+
+    // Saves the baseline with `header` naming the columns (and possibly more lines of comments).
+    void save(const std::filesystem::path& path, std::string_view header) const
+    {
+        std::ofstream ofs{path};
+        for (const auto line : std::views::split(header, '\n')) {
+            ofs << "# " << std::string_view{std::begin(line), std::end(line)} << '\n';
+        }
+        for (const auto& [key, figures] : measurements) {
+            ofs << key.first << ' ' << key.second;
+            for (const auto figure : figures) { ofs << std::format(" {:.4f}"sv, figure); }
+            ofs << '\n';
+        }
+        if (!ofs) { throw std::runtime_error{std::format("{}: cannot record the baseline"sv, path.string())}; }
+    }
+};
+
+// of the throughput, recorded on the machine to check
+const std::filesystem::path throughput_baseline_path{STATEMENT_PERF_BASELINE};
+// of the allocations and the bytes per statement, committed along with the sources
+const std::filesystem::path allocation_baseline_path{STATEMENT_PERF_ALLOCATIONS};
+constexpr auto allocation_baseline_header =
+    "standard_library name allocations_per_statement bytes_per_statement\n"
+    "recorded with the standard libraries providing the <format> of C++20 (e.g., libstdc++-13\n"
+    "of GCC 13, libc++-17 of Clang 17, or msvc-stl-143 of MSVC) by their major versions"sv;
+
+#ifdef NDEBUG
+double tolerance()
+{
+    const auto value = std::getenv("STATEMENT_PERF_TOLERANCE");
+    return value ? std::stod(value) : 0.3;
+}
+#endif
+
+// Returns whether the environment variable `name` is set to other than 0
+// (e.g., STATEMENT_PERF_RECORD=1).
+bool switched_on(const char* name)
+{
+    const auto value = std::getenv(name);
+    return value && value != "0"sv;
+}
+
+volatile std::uint64_t g_sink;
+
+// Returns the number of calls to `f` per second for at least 50 ms.
+template<typename F>
+double calls_per_second(F f)
+{
+    using clock = std::chrono::steady_clock;
+    std::size_t calls = 0;
+    const auto start = clock::now();
+    auto elapsed = clock::duration{};
+    do {
+        f();
+        ++calls;
+        elapsed = clock::now() - start;
+    } while (elapsed < 50ms);
+    return static_cast<double>(calls) / std::chrono::duration<double>(elapsed).count();
+}
+
+// Formats and hashes numbers much as rendering statements does,
+// whose speed stands for that of the machine at the moment.
+void calibrate()
+{
+    std::array<char, 16> buffer{};
+    ContentHash hash;
+    for (int i = 0; i < 10'000; ++i) {
+        const auto [end, ec] = std::to_chars(std::data(buffer), std::data(buffer) + std::size(buffer), i * 7919);
+        hash.add(std::string_view{std::data(buffer), end});
+    }
+    g_sink = hash.digest();
+}
+
+// Measures `render` rendering `num_statements` statements per call, with its throughput
+// relative to that of `calibrate` measured right before so that the load of the machine
+// (or its clock) matters little; takes the median of a few repetitions.
+template<typename F>
+Measurement measure(F render, std::size_t num_statements)
+{
+    // warm up (e.g., caches) before counting
+    render();
+    const AllocationCounter counter;
+    render();
+    const auto allocations_per_call = counter.stats();
+
+    std::array<double, 5> ratios{};
+    for (auto& ratio : ratios) {
+        const auto reference = calls_per_second(calibrate);
+        ratio = calls_per_second(render) * static_cast<double>(num_statements) / reference;
+    }
+    std::ranges::nth_element(ratios, std::begin(ratios) + std::ssize(ratios) / 2);
+    return {
+        .relative_throughput = ratios[std::size(ratios) / 2],
+        .allocations_per_statement =
+            static_cast<double>(allocations_per_call.allocations) / static_cast<double>(num_statements),
+        .bytes_per_statement =
+            static_cast<double>(allocations_per_call.bytes) / static_cast<double>(num_statements),
+    };
+}
+
+// Checks `measured` against the baselines of `name`, except for the allocations
+// unless `allocations_checked` (e.g., of the threads, which vary with the hardware);
+// fails if a baseline to check against is missing.
+void check(std::string_view name, const Measurement& measured, bool allocations_checked = true)
+{
+    Test::RecordProperty("relative_throughput", std::format("{:.4f}"sv, measured.relative_throughput));
+    Test::RecordProperty("allocations_per_statement", std::format("{:.2f}"sv, measured.allocations_per_statement));
+    Test::RecordProperty("bytes_per_statement", std::format("{:.2f}"sv, measured.bytes_per_statement));
+
+    const std::string measurement{name};
+    if (allocations_checked) {
+        auto allocations = Baseline<2>::load(allocation_baseline_path);
+        // to be committed to the baseline if the change is intended
+        const auto line = std::format(
+            "{} {} {:.4f} {:.4f}"sv, standard_library(), name,
+            measured.allocations_per_statement, measured.bytes_per_statement);
+        if (switched_on("STATEMENT_PERF_RECORD_ALLOCATIONS")) {
+            allocations.measurements.insert_or_assign(
+                {standard_library(), measurement},
+                std::array{measured.allocations_per_statement, measured.bytes_per_statement});
+            allocations.save(allocation_baseline_path, allocation_baseline_header);
+        }
+        else if (const auto expected = allocations.find(standard_library(), measurement)) {
+            // allowing for rounding in the baseline
+            EXPECT_LE(measured.allocations_per_statement, (*expected)[0] + 0.00005)
+                << "more allocations per statement than the baseline (measured: " << line << ")";
+            EXPECT_LE(measured.bytes_per_statement, (*expected)[1] + 0.00005)
+                << "more bytes allocated per statement than the baseline (measured: " << line << ")";
+        }
+        else {
+            ADD_FAILURE() << "no allocation baseline of " << name << " for " << standard_library()
+                << " in " << allocation_baseline_path << " (measured: " << line << ")";
+        }
+    }
+
+    auto throughputs = Baseline<1>::load(throughput_baseline_path);
+    if (switched_on("STATEMENT_PERF_RECORD")) {
+        throughputs.measurements.insert_or_assign({platform(), measurement}, std::array{measured.relative_throughput});
+        throughputs.save(throughput_baseline_path, "platform name relative_throughput"sv);
+        return;
+    }
+#ifdef NDEBUG
+    if (const auto expected = throughputs.find(platform(), measurement)) {
+        EXPECT_GE(measured.relative_throughput, (*expected)[0] * (1.0 - tolerance()))
+            << "lower throughput than the baseline";
+    }
+    else {
+        ADD_FAILURE() << "no throughput baseline of " << name << " for " << platform()
+            << " in " << throughput_baseline_path << " (run with STATEMENT_PERF_RECORD=1 to record it)";
+    }
+#endif
+}
+
+// Keeps `text` from being optimized away.
+void keep(const std::string& text)
+{
+    g_sink = std::size(text);
+}
+
+const SyntheticData& data()
+{
+    static const auto data = make_synthetic_data({});
+    return data;
+}
+
+TEST(StatementPerfTest, Statement)
+{
+    const auto& [plays, invoices] = data();
+    check("statement"sv, measure([&]
+    {
+        for (const auto& invoice : invoices) { keep(statement(invoice, plays)); }
+    }, std::size(invoices)));
+}
+
+TEST(StatementPerfTest, StatementResolved)
+{
+    const auto& [plays, invoices] = data();
+    const PlayCatalog catalog{plays};
+    auto resolved = invoices;
+    for (auto& invoice : resolved) { catalog.resolve(invoice); }
+    check("statement_resolved"sv, measure([&]
+    {
+        for (const auto& invoice : resolved) { keep(statement(invoice, catalog)); }
+    }, std::size(resolved)));
+}
+
+TEST(StatementPerfTest, Statements)
+{
+    const auto& [plays, invoices] = data();
+    const PlayCatalog catalog{plays};
+    std::string out;
+    check("statements"sv, measure([&]
+    {
+        out.clear();
+        statements(invoices, catalog, out);
+        keep(out);
+    }, std::size(invoices)));
+}
+
+TEST(StatementPerfTest, StatementsParallel)
+{
+    const auto& [plays, invoices] = data();
+    const PlayCatalog catalog{plays};
+    std::string out;
+    check("statements_parallel"sv, measure([&]
+    {
+        out.clear();
+        statements(std::execution::par, invoices, catalog, out);
+        keep(out);
+    }, std::size(invoices)), false);
+}
+
+TEST(StatementPerfTest, LineCache)
+{
+    const auto& [plays, invoices] = data();
+    const PlayCatalog catalog{plays};
+    LineCache cache{10'000};
+    std::string out;
+    check("statements_line_cache"sv, measure([&]
+    {
+        out.clear();
+        statements(invoices, catalog, cache, out);
+        keep(out);
+    }, std::size(invoices)));
+}
+
+TEST(StatementPerfTest, StatementCache)
+{
+    const auto& [plays, invoices] = data();
+    const PlayCatalog catalog{plays};
+    StatementCache cache{std::size(invoices)};
+    check("statement_cache"sv, measure([&]
+    {
+        for (const auto& invoice : invoices) { keep(cache.statement(invoice, catalog)); }
+    }, std::size(invoices)));
+}
+
+}
@@ -0,0 +1,88 @@
+#include "pch.h"
+
+#include "statement_pipeline.h"
+
+#include "bounded_queue.h"
+#include "play_catalog.h"
+
+namespace {
+
+template<typename Plays>
+void run_pipeline(
+    const InvoiceSource& load, const Plays& plays, const StatementSink& write,
+    const PipelineOptions& options)
+{
+    BoundedQueue<Invoice> invoices{options.max_pending_invoices};
+    BoundedQueue<std::string> texts{options.max_pending_statements};
+    std::exception_ptr load_error;
+    std::exception_ptr render_error;
+    std::exception_ptr write_error;
+
+    {
+        std::jthread loader{[&]
+        {
+            try {
+                while (auto invoice = load()) {
+                    if (!invoices.push(std::move(*invoice))) { break; }
+                }
+            }
+            catch (...) {
+                load_error = std::current_exception();
+            }
+            invoices.close();
+        }};
+
+        std::jthread renderer{[&]
+        {
+            try {
+                while (auto invoice = invoices.pop()) {
+                    std::string text;
+                    statements({&*invoice, 1}, plays, text);
+                    if (!texts.push(std::move(text))) { break; }
+                }
+            }
+            catch (...) {
+                render_error = std::current_exception();
+                // let the loader stop as well
+                invoices.close();
+            }
+            texts.close();
+        }};
+
+        try {
+            while (auto text = texts.pop()) { write(std::move(*text)); }
+        }
+        catch (...) {
+            write_error = std::current_exception();
+            texts.close();
+            invoices.close();
+        }
+    }
+
+    for (const auto& error : {load_error, render_error, write_error}) {
+        if (error) { std::rethrow_exception(error); }
+    }
+}
+
+}
+
+void run_statement_pipeline(
+    const InvoiceSource& load, const std::map<std::string, Play>& plays, const StatementSink& write,
+    const PipelineOptions& options)
+{
+    run_pipeline(load, plays, write, options);
+}
+
+void run_statement_pipeline(
+    const InvoiceSource& load, const PlayCatalog& plays, const StatementSink& write,
+    const PipelineOptions& options)
+{
+    run_pipeline(load, plays, write, options);
+}
+
+void run_statement_pipeline(
+    Generator<Invoice> invoices, const PlayCatalog& plays, const StatementSink& write,
+    const PipelineOptions& options)
+{
+    run_pipeline([&] { return invoices.next(); }, plays, write, options);
+}
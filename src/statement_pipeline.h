@@ -0,0 +1,36 @@
+#pragma once
+
+#include "generator.h"
+#include "statement.h"
+
+struct PipelineOptions
+{
+    // capacities of the queues between the stages, which bound the invoices loaded but not yet
+    // rendered and the statements rendered but not yet written (i.e., the memory in use)
+    std::size_t max_pending_invoices = 64;
+    std::size_t max_pending_statements = 64;
+};
+
+// Returns the next invoice or `std::nullopt` at the end.
+using InvoiceSource = std::function<std::optional<Invoice>()>;
+// Writes a statement.
+using StatementSink = std::function<void(std::string statement)>;
+
+// Loads invoices from `load`, renders their statements, and writes them to `write` in order
+// as overlapped stages on their own threads, connected by bounded queues
+// so that a stage gets ahead of the next by no more than `options` allow
+// (and `write` is called on this thread).
+// If any stage throws, the stages stop as soon as possible (with the statements rendered
+// before written) and the exception is rethrown once all of them have stopped,
+// preferring the earlier stage's if more than one throw.
+void run_statement_pipeline(
+    const InvoiceSource& load, const std::map<std::string, Play>& plays, const StatementSink& write,
+    const PipelineOptions& options = {});
+void run_statement_pipeline(
+    const InvoiceSource& load, const PlayCatalog& plays, const StatementSink& write,
+    const PipelineOptions& options = {});
+
+// Does the same as `run_statement_pipeline` loading invoices from a coroutine.
+void run_statement_pipeline(
+    Generator<Invoice> invoices, const PlayCatalog& plays, const StatementSink& write,
+    const PipelineOptions& options = {});
@@ -0,0 +1,108 @@
+#include "pch.h"
+
+#include "statement_pipeline.h"
+
+#include "play_catalog.h"
+
+#include <gtest/gtest.h>
+#include <gmock/gmock.h>
+
+using namespace testing;
+
+namespace {
+
+const std::map<std::string, Play> plays{
+    {"hamlet"s, {.name = "Hamlet"s, .type = Play::Type::Tragedy}},
+    {"as-like"s, {.name = "As You Like It"s, .type = Play::Type::Comedy}},
+    {"othello"s, {.name = "Othello"s, .type = Play::Type::Tragedy}},
+};
+
+Invoice make_invoice(int i)
+{
+    const std::array play_ids{"hamlet"s, "as-like"s, "othello"s};
+    Invoice invoice{.customer = std::format("Customer #{}"sv, i), .performances = {}};
+    for (int j = 0; j < i % 7; ++j) {
+        invoice.performances.push_back({.play_id = play_ids[(i + j) % 3], .audience = i * j % 100});
+    }
+    return invoice;
+}
+
+Generator<Invoice> generate_invoices(int size)
+{
+    for (int i = 0; i < size; ++i) { co_yield make_invoice(i); }
+}
+
+std::string expected_statements(int size)
+{
+    std::string text;
+    for (int i = 0; i < size; ++i) { text += statement(make_invoice(i), plays); }
+    return text;
+}
+
+TEST(StatementPipelineTest, Run)
+{
+    int next = 0;
+    std::string actual_text;
+    run_statement_pipeline(
+        [&]() -> std::optional<Invoice>
+        {
+            if (next == 500) { return std::nullopt; }
+            return make_invoice(next++);
+        },
+        plays,
+        [&](std::string statement) { actual_text += statement; },
+        {.max_pending_invoices = 3, .max_pending_statements = 2});
+
+    EXPECT_EQ(actual_text, expected_statements(500));
+}
+
+TEST(StatementPipelineTest, Generator)
+{
+    std::string actual_text;
+    run_statement_pipeline(
+        generate_invoices(500), PlayCatalog{plays},
+        [&](std::string statement) { actual_text += statement; });
+
+    EXPECT_EQ(actual_text, expected_statements(500));
+}
+
+TEST(StatementPipelineTest, Failure)
+{
+    auto failing_invoices = []() -> Generator<Invoice>
+    {
+        for (int i = 0; i < 10; ++i) { co_yield make_invoice(i); }
+        throw std::runtime_error{"connection reset"s};
+    };
+
+    std::string actual_text;
+    EXPECT_THAT(
+        [&]
+        {
+            run_statement_pipeline(
+                failing_invoices(), PlayCatalog{plays},
+                [&](std::string statement) { actual_text += statement; });
+        },
+        ThrowsMessage<std::runtime_error>(Eq("connection reset"s)));
+    // everything loaded is written nevertheless
+    EXPECT_EQ(actual_text, expected_statements(10));
+
+    int next = 0;
+    EXPECT_THROW(
+        run_statement_pipeline(
+            [&]() -> std::optional<Invoice>
+            {
+                auto invoice = make_invoice(next++);
+                if (next == 100) { invoice.performances.push_back({.play_id = "unknown"s, .audience = 1}); }
+                return invoice;
+            },
+            plays, [](std::string) {}),
+        std::out_of_range);
+
+    EXPECT_THROW(
+        run_statement_pipeline(
+            generate_invoices(1000), PlayCatalog{plays},
+            [](std::string) { throw std::runtime_error{"disk full"s}; }),
+        std::runtime_error);
+}
+
+}
@@ -0,0 +1,159 @@
+#include "pch.h"
+
+#include "statement_renderers.h"
+
+#include "play_catalog.h"
+#include "render_statement.h"
+
+namespace {
+
+void append_html_escaped(std::string& out, std::string_view text)
+{
+    for (const auto c : text) {
+        switch (c) {
+        case '&': out += "&amp;"sv; break;
+        case '<': out += "&lt;"sv; break;
+        case '>': out += "&gt;"sv; break;
+        case '"': out += "&quot;"sv; break;
+        case '\'': out += "&#39;"sv; break;
+        default: out += c; break;
+        }
+    }
+}
+
+void append_json_string(std::string& out, std::string_view text)
+{
+    out += '"';
+    for (const auto c : text) {
+        switch (c) {
+        case '"': out += "\\\""sv; break;
+        case '\\': out += "\\\\"sv; break;
+        case '\n': out += "\\n"sv; break;
+        case '\r': out += "\\r"sv; break;
+        case '\t': out += "\\t"sv; break;
+        default:
+            if (static_cast<unsigned char>(c) < 0x20) {
+                std::format_to(std::back_inserter(out), "\\u{:04x}"sv, static_cast<unsigned>(c));
+            }
+            else {
+                out += c;
+            }
+            break;
+        }
+    }
+    out += '"';
+}
+
+void append_csv_field(std::string& out, std::string_view text)
+{
+    if (text.find_first_of(",\"\r\n"sv) == std::string_view::npos) {
+        out += text;
+        return;
+    }
+    out += '"';
+    for (const auto c : text) {
+        if (c == '"') { out += '"'; }
+        out += c;
+    }
+    out += '"';
+}
+
+// Appends `amount` in dollars with two decimal places regardless of the locale, e.g., "-0.05".
+void append_decimal(std::string& out, Money amount)
+{
+    const auto cents = amount.units();
+    const auto magnitude = cents < 0 ?
+        0 - static_cast<std::uint64_t>(cents) : static_cast<std::uint64_t>(cents);
+    std::format_to(
+        std::back_inserter(out), "{}{}.{:02}"sv, cents < 0 ? "-"sv : ""sv, magnitude / 100, magnitude % 100);
+}
+
+template<typename Plays>
+std::vector<std::string> render_formats_impl(
+    const Invoice& invoice, const Plays& plays, std::span<const StatementRenderer> renderers)
+{
+    const auto data = make_statement_data(invoice, plays);
+    // once for all the renderers (any of which would otherwise fail after the others have rendered)
+    checked(data.total_amount);
+    std::vector<std::string> outs(std::size(renderers));
+    for (std::size_t i = 0; i < std::size(renderers); ++i) { renderers[i](data, outs[i]); }
+    return outs;
+}
+
+}
+
+void render_text(const StatementData& data, std::string& out)
+{
+    out.reserve(std::size(out) + estimated_statement_size(data));
+    auto it = render_header(std::back_inserter(out), data.customer);
+    for (const auto& perf : data.performances) {
+        it = render_line(it, perf.play.name, perf.amount, perf.base.audience);
+    }
+    render_footer(it, data.total_amount, data.total_volume_credits);
+}
+
+void render_html(const StatementData& data, std::string& out)
+{
+    out += "<h1>Statement for "sv;
+    append_html_escaped(out, data.customer);
+    out += "</h1>\n<table>\n<tr><th>play</th><th>seats</th><th>cost</th></tr>\n"sv;
+    for (const auto& perf : data.performances) {
+        out += "<tr><td>"sv;
+        append_html_escaped(out, perf.play.name);
+        std::format_to(
+            std::back_inserter(out), "</td><td>{}</td><td>{}</td></tr>\n"sv,
+            perf.base.audience, Usd{perf.amount});
+    }
+    std::format_to(
+        std::back_inserter(out),
+        "</table>\n<p>Amount owed is <em>{}</em></p>\n<p>You earned <em>{}</em> credits</p>\n"sv,
+        Usd{checked(data.total_amount).units()}, data.total_volume_credits);
+}
+
+void render_json(const StatementData& data, std::string& out)
+{
+    out += "{\"customer\":"sv;
+    append_json_string(out, data.customer);
+    out += ",\"performances\":["sv;
+    for (bool first = true; const auto& perf : data.performances) {
+        if (!std::exchange(first, false)) { out += ','; }
+        out += "{\"play\":"sv;
+        append_json_string(out, perf.play.name);
+        std::format_to(
+            std::back_inserter(out), ",\"audience\":{},\"amount\":{},\"volume_credits\":{}}}"sv,
+            perf.base.audience, perf.amount, perf.volume_credits);
+    }
+    std::format_to(
+        std::back_inserter(out), "],\"total_amount\":{},\"total_volume_credits\":{}}}\n"sv,
+        checked(data.total_amount).units(), data.total_volume_credits);
+}
+
+void render_csv(const StatementData& data, std::string& out)
+{
+    out += "customer,play,seats,amount,credits\r\n"sv;
+    for (const auto& perf : data.performances) {
+        append_csv_field(out, data.customer);
+        out += ',';
+        append_csv_field(out, perf.play.name);
+        std::format_to(std::back_inserter(out), ",{},"sv, perf.base.audience);
+        append_decimal(out, Money{perf.amount});
+        std::format_to(std::back_inserter(out), ",{}\r\n"sv, perf.volume_credits);
+    }
+    append_csv_field(out, data.customer);
+    out += ",,,"sv;
+    append_decimal(out, checked(data.total_amount));
+    std::format_to(std::back_inserter(out), ",{}\r\n"sv, data.total_volume_credits);
+}
+
+std::vector<std::string> render_formats(
+    const Invoice& invoice, const std::map<std::string, Play>& plays,
+    std::span<const StatementRenderer> renderers)
+{
+    return render_formats_impl(invoice, plays, renderers);
+}
+
+std::vector<std::string> render_formats(
+    const Invoice& invoice, const PlayCatalog& plays, std::span<const StatementRenderer> renderers)
+{
+    return render_formats_impl(invoice, plays, renderers);
+}
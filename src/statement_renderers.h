@@ -0,0 +1,31 @@
+#pragma once
+
+#include "make_statement_data.h"
+
+// Renders the statement calculated in `data` in some format, appending it to `out`.
+using StatementRenderer = std::function<void(const StatementData& data, std::string& out)>;
+
+// Render `data` as the plain text `statement` returns,
+// as an HTML fragment (with the names escaped),
+// as a JSON object (with the amounts in cents), e.g.,
+//
+//     {"customer":"BigCo","performances":[{"play":"Hamlet","audience":55,"amount":65000,
+//     "volume_credits":25},...],"total_amount":173000,"total_volume_credits":47}
+//
+// (all on one line), and as CSV with a header row, a row per performance, and a row of the totals
+// with the play and the seats left empty (with the amounts in dollars without the thousands
+// separators, e.g., "BigCo,,,1730.00,47").
+void render_text(const StatementData& data, std::string& out);
+void render_html(const StatementData& data, std::string& out);
+void render_json(const StatementData& data, std::string& out);
+void render_csv(const StatementData& data, std::string& out);
+
+// Calculates the statement for `invoice` only once and renders it with each of `renderers`,
+// returning the results in the same order;
+// throws what `make_statement_data` throws, or `std::overflow_error` if the total amount is saturated,
+// before rendering anything.
+std::vector<std::string> render_formats(
+    const Invoice& invoice, const std::map<std::string, Play>& plays,
+    std::span<const StatementRenderer> renderers);
+std::vector<std::string> render_formats(
+    const Invoice& invoice, const PlayCatalog& plays, std::span<const StatementRenderer> renderers);
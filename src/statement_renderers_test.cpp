@@ -0,0 +1,100 @@
+#include "pch.h"
+
+#include "statement_renderers.h"
+
+#include "play_catalog.h"
+
+#include <gtest/gtest.h>
+#include <gmock/gmock.h>
+
+using namespace testing;
+
+namespace {
+
+const std::map<std::string, Play> plays{
+    {"hamlet"s, {.name = "Hamlet"s, .type = Play::Type::Tragedy}},
+    {"as-like"s, {.name = "As You Like It"s, .type = Play::Type::Comedy}},
+    {"othello"s, {.name = "Othello"s, .type = Play::Type::Tragedy}},
+};
+
+const Invoice invoice{
+    .customer = "BigCo"s,
+    .performances = {
+        {.play_id = "hamlet"s, .audience = 55},
+        {.play_id = "as-like"s, .audience = 35},
+        {.play_id = "othello"s, .audience = 40},
+    }
+};
+
+TEST(StatementRenderersTest, BigCo)
+{
+    const std::array<StatementRenderer, 4> renderers{render_text, render_html, render_json, render_csv};
+    const auto outs = render_formats(invoice, plays, renderers);
+    ASSERT_EQ(std::size(outs), 4);
+
+    EXPECT_EQ(outs[0], statement(invoice, plays));
+
+    EXPECT_EQ(outs[1], R"###(<h1>Statement for BigCo</h1>
+<table>
+<tr><th>play</th><th>seats</th><th>cost</th></tr>
+<tr><td>Hamlet</td><td>55</td><td>$650.00</td></tr>
+<tr><td>As You Like It</td><td>35</td><td>$580.00</td></tr>
+<tr><td>Othello</td><td>40</td><td>$500.00</td></tr>
+</table>
+<p>Amount owed is <em>$1,730.00</em></p>
+<p>You earned <em>47</em> credits</p>
+)###"s);
+
+    EXPECT_EQ(
+        outs[2],
+        R"({"customer":"BigCo","performances":[)"
+        R"({"play":"Hamlet","audience":55,"amount":65000,"volume_credits":25},)"
+        R"({"play":"As You Like It","audience":35,"amount":58000,"volume_credits":12},)"
+        R"({"play":"Othello","audience":40,"amount":50000,"volume_credits":10}],)"
+        R"("total_amount":173000,"total_volume_credits":47})" "\n"s);
+
+    EXPECT_EQ(
+        outs[3],
+        "customer,play,seats,amount,credits\r\n"
+        "BigCo,Hamlet,55,650.00,25\r\n"
+        "BigCo,As You Like It,35,580.00,12\r\n"
+        "BigCo,Othello,40,500.00,10\r\n"
+        "BigCo,,,1730.00,47\r\n"s);
+
+    // the same with `PlayCatalog`
+    EXPECT_EQ(render_formats(invoice, PlayCatalog{plays}, renderers), outs);
+
+    // nothing is rendered for an unknown play
+    auto bad_invoice = invoice;
+    bad_invoice.performances[1].play_id = "unknown"s;
+    EXPECT_THROW(render_formats(bad_invoice, plays, renderers), std::out_of_range);
+}
+
+TEST(StatementRenderersTest, Escaped)
+{
+    const std::map<std::string, Play> odd_plays{
+        {"rj"s, {.name = "Romeo & \"Juliet\", <Act I>\n"s, .type = Play::Type::Tragedy}},
+    };
+    const Invoice odd_invoice{.customer = "O'Neil\\Co"s, .performances = {{.play_id = "rj"s, .audience = 30}}};
+    const auto data = make_statement_data(odd_invoice, odd_plays);
+
+    std::string html;
+    render_html(data, html);
+    EXPECT_THAT(html, HasSubstr("<h1>Statement for O&#39;Neil\\Co</h1>"s));
+    EXPECT_THAT(html, HasSubstr("<td>Romeo &amp; &quot;Juliet&quot;, &lt;Act I&gt;\n</td>"s));
+
+    std::string json;
+    render_json(data, json);
+    EXPECT_THAT(json, HasSubstr(R"("customer":"O'Neil\\Co")"s));
+    EXPECT_THAT(json, HasSubstr(R"("play":"Romeo & \"Juliet\", <Act I>\n")"s));
+
+    std::string csv;
+    render_csv(data, csv);
+    EXPECT_EQ(
+        csv,
+        "customer,play,seats,amount,credits\r\n"
+        "O'Neil\\Co,\"Romeo & \"\"Juliet\"\", <Act I>\n\",30,400.00,0\r\n"
+        "O'Neil\\Co,,,400.00,0\r\n"s);
+}
+
+}
@@ -2,6 +2,9 @@
 
 #include "statement.h"
 
+#include "alloc_check.h"
+#include "play_catalog.h"
+
 #include <gtest/gtest.h>
 #include <gmock/gmock.h>
 
@@ -48,6 +51,35 @@ You earned 47 credits
     EXPECT_EQ(actual_text, expected_text);
 }
 
+TEST(StatementTest, TotalBeyondInt)
+{
+    const std::map<std::string, Play> plays{
+        {"hamlet"s, {.name = "Hamlet"s, .type = Play::Type::Tragedy}},
+    };
+
+    // each line fits in `int` but the total does not
+    const Invoice invoice{
+        .customer = "Festival"s,
+        .performances = {
+            {.play_id = "hamlet"s, .audience = 1'000'000},
+            {.play_id = "hamlet"s, .audience = 1'000'000},
+            {.play_id = "hamlet"s, .audience = 1'000'000},
+        }
+    };
+
+    const auto actual_text = statement(invoice, plays);
+
+    const auto expected_text = R"###(Statement for Festival
+  Hamlet: $10,000,100.00 (1000000 seats)
+  Hamlet: $10,000,100.00 (1000000 seats)
+  Hamlet: $10,000,100.00 (1000000 seats)
+Amount owed is $30,000,300.00
+You earned 2999910 credits
+)###"s;
+
+    EXPECT_EQ(actual_text, expected_text);
+}
+
 TEST(StatementTest, UnknownType)
 {
     const std::map<std::string, Play> plays{
@@ -69,4 +101,457 @@ TEST(StatementTest, UnknownType)
         ThrowsMessage<std::runtime_error>(Eq("-1: unknown Play::Type"s)));
 }
 
+TEST(StatementTest, StatementsWithErrors)
+{
+    const std::map<std::string, Play> plays{
+        {"hamlet"s, {.name = "Hamlet"s, .type = Play::Type::Tragedy}},
+        {"as-like"s, {.name = "As You Like It"s, .type = Play::Type::Comedy}},
+        {"xyz"s, {.name = "XYZ"s, .type = static_cast<Play::Type>(-1)}},
+    };
+
+    std::vector<Invoice> invoices{
+        {
+            .customer = "BigCo"s,
+            .performances = {
+                {
+                    .play_id = "hamlet"s,
+                    .audience = 55
+                },
+            }
+        },
+        {
+            .customer = "UT KK"s,
+            .performances = {
+                {
+                    .play_id = "as-like"s,
+                    .audience = 10
+                },
+                {
+                    .play_id = "xyz"s,
+                    .audience = 10
+                },
+            }
+        },
+        {
+            .customer = "SmallCo"s,
+            .performances = {
+                {
+                    .play_id = "as-like"s,
+                    .audience = 10
+                },
+            }
+        },
+        {
+            .customer = "MissCo"s,
+            .performances = {
+                {
+                    .play_id = "macbeth"s,
+                    .audience = 10
+                },
+            }
+        },
+    };
+
+    auto actual_text = "(previous batch)\n"s;
+    std::vector<StatementError> errors;
+    statements(invoices, plays, actual_text, errors);
+
+    const auto expected_text =
+        "(previous batch)\n"s + statement(invoices[0], plays) + statement(invoices[2], plays);
+    EXPECT_EQ(actual_text, expected_text);
+
+    ASSERT_EQ(std::size(errors), 2);
+    EXPECT_EQ(errors[0].code, StatementError::Code::unknown_type);
+    EXPECT_EQ(errors[0].invoice, 1);
+    EXPECT_EQ(errors[0].performance, 1);
+    EXPECT_EQ(message(errors[0], invoices), "-1: unknown Play::Type"s);
+    EXPECT_EQ(errors[1].code, StatementError::Code::unknown_play_id);
+    EXPECT_EQ(errors[1].invoice, 3);
+    EXPECT_EQ(errors[1].performance, 0);
+    EXPECT_EQ(message(errors[1], invoices), "macbeth: unknown play ID"s);
+    EXPECT_EQ(
+        message({.code = StatementError::Code::overflow, .invoice = 0, .performance = 0, .type = {}}, invoices),
+        "BigCo: total amount overflow"s);
+
+    // the throwing contract of `statement` is kept
+    EXPECT_THAT(
+        [&] { statement(invoices[1], plays); },
+        ThrowsMessage<std::runtime_error>(Eq("-1: unknown Play::Type"s)));
+}
+
+TEST(StatementTest, Statements)
+{
+    const std::map<std::string, Play> plays{
+        {"hamlet"s, {.name = "Hamlet"s, .type = Play::Type::Tragedy}},
+        {"as-like"s, {.name = "As You Like It"s, .type = Play::Type::Comedy}},
+    };
+
+    const std::vector<Invoice> invoices{
+        {
+            .customer = "BigCo"s,
+            .performances = {
+                {
+                    .play_id = "hamlet"s,
+                    .audience = 55
+                },
+            }
+        },
+        {
+            .customer = "SmallCo"s,
+            .performances = {
+                {
+                    .play_id = "as-like"s,
+                    .audience = 10
+                },
+                {
+                    .play_id = "hamlet"s,
+                    .audience = 20
+                },
+            }
+        },
+    };
+
+    auto actual_text = "(previous batch)\n"s;
+    statements(invoices, plays, actual_text);
+
+    const auto expected_text = R"###((previous batch)
+Statement for BigCo
+  Hamlet: $650.00 (55 seats)
+Amount owed is $650.00
+You earned 25 credits
+Statement for SmallCo
+  As You Like It: $330.00 (10 seats)
+  Hamlet: $400.00 (20 seats)
+Amount owed is $730.00
+You earned 2 credits
+)###"s;
+
+    EXPECT_EQ(actual_text, expected_text);
+
+    std::ostringstream oss;
+    oss << "(previous batch)\n"sv;
+    statements(invoices, plays, oss);
+
+    EXPECT_EQ(oss.str(), expected_text);
+}
+
+TEST(StatementTest, LargeAudiences)
+{
+    const std::map<std::string, Play> plays{
+        {"hamlet"s, {.name = "Hamlet"s, .type = Play::Type::Tragedy}},
+        {"as-like"s, {.name = "As You Like It"s, .type = Play::Type::Comedy}},
+    };
+    const Invoice invoice{
+        .customer = "BigCo"s,
+        .performances = {
+            {.play_id = "hamlet"s, .audience = std::numeric_limits<int>::max()},
+            {.play_id = "as-like"s, .audience = std::numeric_limits<int>::max() - 1},
+        }
+    };
+
+    // each line far beyond `int` (in cents) but exact
+    EXPECT_EQ(statement(invoice, plays), R"###(Statement for BigCo
+  Hamlet: $21,474,836,570.00 (2147483647 seats)
+  As You Like It: $17,179,869,468.00 (2147483646 seats)
+Amount owed is $38,654,706,038.00
+You earned 4724463962 credits
+)###"s);
+}
+
+TEST(StatementTest, Allocations)
+{
+#if defined(_ITERATOR_DEBUG_LEVEL) && _ITERATOR_DEBUG_LEVEL != 0
+    // the checked iterators of MSVC allocate (e.g., a proxy for each string)
+    GTEST_SKIP() << "counted exactly only without iterator debugging";
+#endif
+    const std::map<std::string, Play> plays{
+        {"hamlet"s, {.name = "Hamlet"s, .type = Play::Type::Tragedy}},
+        {"as-like"s, {.name = "As You Like It"s, .type = Play::Type::Comedy}},
+        {"othello"s, {.name = "Othello"s, .type = Play::Type::Tragedy}},
+    };
+    const PlayCatalog catalog{plays};
+
+    const std::vector<Invoice> invoices(
+        10,
+        Invoice{
+            .customer = "BigCo"s,
+            .performances = {
+                {.play_id = "hamlet"s, .audience = 55},
+                {.play_id = "as-like"s, .audience = 35},
+                {.play_id = "othello"s, .audience = 40},
+            }
+        });
+
+    // nothing but the text returned (no more than once, as documented,
+    // however the standard library implements small strings and `reserve`)
+    {
+        const AllocationCounter counter;
+        const auto text = statement(invoices[0], plays);
+        const auto stats = counter.stats();
+        EXPECT_LE(stats.allocations, 1);
+        EXPECT_EQ(stats.deallocations, 0);
+        EXPECT_GT(stats.bytes, std::size(text));
+    }
+    {
+        const AllocationCounter counter;
+        const auto text = statement(invoices[0], catalog);
+        EXPECT_LE(counter.stats().allocations, 1);
+    }
+
+    // and nothing at all into the text reused
+    std::string out;
+    statements(invoices, plays, out);
+    {
+        out.clear();
+        const AllocationCounter counter;
+        statements(invoices, plays, out);
+        EXPECT_EQ(counter.stats().allocations, 0);
+    }
+    {
+        out.clear();
+        const AllocationCounter counter;
+        statements(invoices, catalog, out);
+        EXPECT_EQ(counter.stats().allocations, 0);
+    }
+}
+
+TEST(StatementTest, Pmr)
+{
+    const std::map<std::string, Play> plays{
+        {"hamlet"s, {.name = "Hamlet"s, .type = Play::Type::Tragedy}},
+        {"as-like"s, {.name = "As You Like It"s, .type = Play::Type::Comedy}},
+    };
+
+    // everything must fit in the arena (or `std::bad_alloc` is thrown)
+    std::array<std::byte, 4096> buffer;
+    std::pmr::monotonic_buffer_resource arena{
+        std::data(buffer), std::size(buffer), std::pmr::null_memory_resource()};
+
+    std::pmr::vector<pmr::Invoice> invoices{&arena};
+    auto& big_co = invoices.emplace_back("BigCo with a name too long for any small string"sv);
+    big_co.performances.emplace_back("hamlet and its long play ID too"sv, 55);
+    big_co.performances.emplace_back("as-like"sv, 35);
+    auto& small_co = invoices.emplace_back("SmallCo"sv);
+    small_co.performances.emplace_back("as-like"sv, 10);
+
+    std::map<std::string, Play> long_plays{plays};
+    long_plays.emplace("hamlet and its long play ID too"s, plays.at("hamlet"s));
+
+    const std::vector<Invoice> expected_invoices{
+        {
+            .customer = "BigCo with a name too long for any small string"s,
+            .performances = {
+                {
+                    .play_id = "hamlet and its long play ID too"s,
+                    .audience = 55
+                },
+                {
+                    .play_id = "as-like"s,
+                    .audience = 35
+                },
+            }
+        },
+        {
+            .customer = "SmallCo"s,
+            .performances = {
+                {
+                    .play_id = "as-like"s,
+                    .audience = 10
+                },
+            }
+        },
+    };
+
+    EXPECT_EQ(statement(invoices[0], long_plays), statement(expected_invoices[0], long_plays));
+
+    std::string expected_text;
+    statements(expected_invoices, long_plays, expected_text);
+
+    std::string actual_text;
+    statements(invoices, long_plays, actual_text);
+
+    EXPECT_EQ(actual_text, expected_text);
+}
+
+TEST(StatementTest, PlayHashMap)
+{
+    const std::map<std::string, Play> plays{
+        {"hamlet"s, {.name = "Hamlet"s, .type = Play::Type::Tragedy}},
+        {"as-like"s, {.name = "As You Like It"s, .type = Play::Type::Comedy}},
+        {"othello"s, {.name = "Othello"s, .type = Play::Type::Tragedy}},
+    };
+    const PlayHashMap hashed_plays{std::cbegin(plays), std::cend(plays)};
+
+    std::vector<Invoice> invoices{
+        {
+            .customer = "BigCo"s,
+            .performances = {
+                {.play_id = "hamlet"s, .audience = 55},
+                {.play_id = "as-like"s, .audience = 35},
+                {.play_id = "othello"s, .audience = 40},
+            }
+        },
+        {
+            .customer = "SmallCo"s,
+            .performances = {{.play_id = "as-like"s, .audience = 10}}
+        },
+    };
+
+    EXPECT_EQ(statement(invoices[0], hashed_plays), statement(invoices[0], plays));
+
+    std::string expected_text;
+    statements(invoices, plays, expected_text);
+
+    std::string actual_text;
+    statements(invoices, hashed_plays, actual_text);
+
+    EXPECT_EQ(actual_text, expected_text);
+
+    // along every other path taking plays by ID
+    std::string parallel_text;
+    statements(std::execution::par, invoices, hashed_plays, parallel_text);
+    EXPECT_EQ(parallel_text, expected_text);
+
+    std::ostringstream oss;
+    statements(invoices, hashed_plays, oss);
+    EXPECT_EQ(oss.str(), expected_text);
+
+    const std::vector<PerformanceView> performance_views{{.play_id = "hamlet"sv, .audience = 55}};
+    const InvoiceView invoice_view{.customer = "BigCo"sv, .performances = performance_views};
+    EXPECT_EQ(statement(invoice_view, hashed_plays), statement(invoice_view, plays));
+
+    invoices[1].performances[0].play_id = "macbeth"s;
+    EXPECT_THAT(
+        [&] { statement(invoices[1], hashed_plays); },
+        ThrowsMessage<std::out_of_range>(Eq("macbeth: unknown play ID"s)));
+
+    std::string recorded_text;
+    std::vector<StatementError> errors;
+    statements(invoices, hashed_plays, recorded_text, errors);
+    EXPECT_EQ(recorded_text, statement(invoices[0], plays));
+    ASSERT_EQ(std::size(errors), 1);
+    EXPECT_EQ(message(errors[0], invoices), "macbeth: unknown play ID"s);
+}
+
+TEST(StatementTest, Views)
+{
+    const std::map<std::string, Play> plays{
+        {"hamlet"s, {.name = "Hamlet"s, .type = Play::Type::Tragedy}},
+        {"as-like"s, {.name = "As You Like It"s, .type = Play::Type::Comedy}},
+        {"othello"s, {.name = "Othello"s, .type = Play::Type::Tragedy}},
+    };
+
+    const std::vector<Invoice> invoices{
+        {
+            .customer = "BigCo"s,
+            .performances = {
+                {.play_id = "hamlet"s, .audience = 55},
+                {.play_id = "as-like"s, .audience = 35},
+                {.play_id = "othello"s, .audience = 40},
+            }
+        },
+        {
+            .customer = "SmallCo"s,
+            .performances = {{.play_id = "as-like"s, .audience = 10}}
+        },
+    };
+
+    std::vector<std::vector<PerformanceView>> performance_views;
+    std::vector<InvoiceView> invoice_views;
+    for (const auto& invoice : invoices) {
+        auto& views = performance_views.emplace_back();
+        for (const auto& perf : invoice.performances) {
+            views.push_back({.play_id = perf.play_id, .audience = perf.audience});
+        }
+    }
+    for (std::size_t i = 0; i < std::size(invoices); ++i) {
+        invoice_views.push_back({.customer = invoices[i].customer, .performances = performance_views[i]});
+    }
+
+    EXPECT_EQ(statement(invoice_views[0], plays), statement(invoices[0], plays));
+
+    std::string expected_text;
+    statements(invoices, plays, expected_text);
+
+    std::string actual_text;
+    statements(invoice_views, plays, actual_text);
+
+    EXPECT_EQ(actual_text, expected_text);
+}
+
+TEST(StatementTest, StatementsParallel)
+{
+    const std::map<std::string, Play> plays{
+        {"hamlet"s, {.name = "Hamlet"s, .type = Play::Type::Tragedy}},
+        {"as-like"s, {.name = "As You Like It"s, .type = Play::Type::Comedy}},
+        {"othello"s, {.name = "Othello"s, .type = Play::Type::Tragedy}},
+        {"xyz"s, {.name = "XYZ"s, .type = static_cast<Play::Type>(-1)}},
+    };
+    const std::array play_ids{"hamlet"s, "as-like"s, "othello"s};
+
+    std::vector<Invoice> invoices(1000);
+    for (int i = 0; auto& invoice : invoices) {
+        invoice.customer = std::format("Customer #{}"sv, i);
+        for (int j = 0; j < i % 7; ++j) {
+            invoice.performances.push_back({.play_id = play_ids[(i + j) % 3], .audience = i * j % 100});
+        }
+        ++i;
+    }
+
+    std::string expected_text;
+    statements(invoices, plays, expected_text);
+
+    std::string actual_text;
+    statements(std::execution::par, invoices, plays, actual_text);
+
+    EXPECT_EQ(actual_text, expected_text);
+
+    // the earliest error is reported and the output is left intact
+    invoices[300].performances.push_back({.play_id = "unknown"s, .audience = 1});
+    invoices[700].performances.push_back({.play_id = "xyz"s, .audience = 1});
+    EXPECT_THROW(statements(std::execution::par, invoices, plays, actual_text), std::out_of_range);
+    EXPECT_EQ(actual_text, expected_text);
+}
+
+TEST(StatementTest, StatementsParallelSkewed)
+{
+    const std::map<std::string, Play> plays{
+        {"hamlet"s, {.name = "Hamlet"s, .type = Play::Type::Tragedy}},
+        {"as-like"s, {.name = "As You Like It"s, .type = Play::Type::Comedy}},
+        {"othello"s, {.name = "Othello"s, .type = Play::Type::Tragedy}},
+    };
+    const std::array play_ids{"hamlet"s, "as-like"s, "othello"s};
+
+    // a few large invoices (split among the workers) between small (and empty) ones
+    std::vector<Invoice> invoices(100);
+    for (int i = 0; auto& invoice : invoices) {
+        invoice.customer = std::format("Customer #{}"sv, i);
+        const auto num_performances = i % 30 == 1 ? 10'000 : i % 3;
+        for (int j = 0; j < num_performances; ++j) {
+            invoice.performances.push_back({.play_id = play_ids[(i + j) % 3], .audience = (i + j) % 100});
+        }
+        ++i;
+    }
+
+    std::string expected_text;
+    statements(invoices, plays, expected_text);
+
+    std::string actual_text;
+    statements(std::execution::par, invoices, plays, actual_text);
+
+    EXPECT_EQ(actual_text, expected_text);
+
+    const auto catalog = PlayCatalog{plays};
+    std::string catalog_text;
+    statements(std::execution::par, invoices, catalog, catalog_text);
+
+    EXPECT_EQ(catalog_text, expected_text);
+
+    // the earliest error in the middle of a large invoice is reported and the output is left intact
+    invoices[31].performances[5'000].play_id = "unknown"s;
+    invoices[61].performances[10].play_id = "unknown"s;
+    EXPECT_THROW(statements(std::execution::par, invoices, plays, actual_text), std::out_of_range);
+    EXPECT_EQ(actual_text, expected_text);
+}
+
 }
@@ -0,0 +1,94 @@
+#include "pch.h"
+
+#include "streaming_statement.h"
+
+#include "play_catalog.h"
+#include "render_statement.h"
+
+namespace {
+
+// Writes to `os` through `write(out)` with an output iterator `out`
+// (directly into the stream buffer), setting `badbit` if the writing fails
+// and otherwise counting the bytes written into `counts`.
+template<typename Write>
+void write_to(std::ostream& os, StatementCounts& counts, Write write)
+{
+    const std::ostream::sentry sentry{os};
+    if (!sentry) { return; }
+    std::uint64_t bytes = 0;
+    if (write(CountingOutput{std::ostreambuf_iterator<char>{os}, bytes}).base().failed()) {
+        os.setstate(std::ios_base::badbit);
+        return;
+    }
+    counts.add(0, 0, bytes);
+}
+
+}
+
+StreamingStatement::StreamingStatement(std::string_view customer, const PlayCatalog& plays, std::ostream& os) :
+    plays_{&plays},
+    os_{&os}
+{
+    StatementCounts counts;
+    write_to(os, counts, [&](auto out) { return render_header(out, customer); });
+}
+
+void StreamingStatement::add(const Performance& perf)
+{
+    add_impl(std::span{&perf, 1});
+}
+
+void StreamingStatement::add(const PerformanceView& perf)
+{
+    add_impl(std::span{&perf, 1});
+}
+
+void StreamingStatement::add(std::span<const Performance> perfs)
+{
+    add_impl(perfs);
+}
+
+void StreamingStatement::add(std::span<const PerformanceView> perfs)
+{
+    add_impl(perfs);
+}
+
+void StreamingStatement::finish()
+{
+    if (finished_) { throw std::logic_error{"statement already finished"s}; }
+    // before writing anything (even if `os` has failed), leaving the statement unfinished
+    const auto total_amount = checked(total_amount_);
+    StatementCounts counts;
+    write_to(*os_, counts, [&](auto out) { return render_footer(out, total_amount, volume_credits_); });
+    counts.add(1, 0, 0);
+    finished_ = true;
+}
+
+template<typename AnyPerformance>
+void StreamingStatement::add_impl(std::span<const AnyPerformance> perfs)
+{
+    if (finished_) { throw std::logic_error{"statement already finished"s}; }
+
+    // keep the totals even if the lines cannot be written
+    const std::ostream::sentry sentry{*os_};
+    StatementCounts counts;
+    std::uint64_t bytes = 0;
+    CountingOutput out{std::ostreambuf_iterator<char>{*os_}, bytes};
+    for (const auto& perf : perfs) {
+        const auto& play = counts.look_up([&]() -> decltype(auto) { return plays_->play_for(perf); });
+        const auto this_amount = amount_for(play.type, perf.audience);
+        const auto this_volume_credits = volume_credits_for(play.type, perf.audience);
+        if (sentry) {
+            out = render_line(out, play.name, this_amount, perf.audience);
+            counts.add(0, 1, 0);
+        }
+        ++size_;
+        total_amount_ += Money{this_amount};
+        volume_credits_ += this_volume_credits;
+    }
+    if (sentry && out.base().failed()) {
+        os_->setstate(std::ios_base::badbit);
+        return;
+    }
+    counts.add(0, 0, bytes);
+}
@@ -0,0 +1,46 @@
+#pragma once
+
+#include "money.h"
+#include "statement.h"
+
+// Statement for an invoice rendered while its performances are fed one by one (or in chunks),
+// e.g., as they are parsed from an invoice too large to hold in memory,
+// writing each line to the stream as soon as priced and the footer with the totals at `finish`
+// so that the memory in use stays constant however many performances the invoice has.
+// The text written is the same as `statement` for the invoice with all the performances fed;
+// if `os` fails, the rest of the text is not written but the totals are still kept.
+class StreamingStatement
+{
+public:
+    // Writes the header for `customer` to `os`; `plays` and `os` must outlive this object.
+    StreamingStatement(std::string_view customer, const PlayCatalog& plays, std::ostream& os);
+
+    // Writes the line(s) for `perf` (or `perfs`), throwing `std::out_of_range` if any play is
+    // not cataloged or `std::runtime_error` if any play is of an unknown `Play::Type`
+    // (with the lines before written), or `std::logic_error` if already finished.
+    void add(const Performance& perf);
+    void add(const PerformanceView& perf);
+    void add(std::span<const Performance> perfs);
+    void add(std::span<const PerformanceView> perfs);
+
+    // Writes the footer; throws `std::logic_error` if already finished, or
+    // `std::overflow_error` if the total amount is saturated, writing nothing
+    // (and leaving the statement unfinished, which can only fail again as the total stays saturated).
+    void finish();
+
+    // The number of performances and the totals of those fed so far
+    std::uint64_t size() const noexcept { return size_; }
+    Money total_amount() const noexcept { return total_amount_; }
+    std::int64_t volume_credits() const noexcept { return volume_credits_; }
+
+private:
+    template<typename AnyPerformance>
+    void add_impl(std::span<const AnyPerformance> perfs);
+
+    const PlayCatalog* plays_;
+    std::ostream* os_;
+    std::uint64_t size_ = 0;
+    Money total_amount_;
+    std::int64_t volume_credits_ = 0;
+    bool finished_ = false;
+};
@@ -0,0 +1,164 @@
+#include "pch.h"
+
+#include "streaming_statement.h"
+
+#include "play_catalog.h"
+#include "pricing_rule.h"
+
+#include <gtest/gtest.h>
+#include <gmock/gmock.h>
+
+using namespace testing;
+
+namespace {
+
+const std::map<std::string, Play> plays{
+    {"hamlet"s, {.name = "Hamlet"s, .type = Play::Type::Tragedy}},
+    {"as-like"s, {.name = "As You Like It"s, .type = Play::Type::Comedy}},
+    {"othello"s, {.name = "Othello"s, .type = Play::Type::Tragedy}},
+};
+
+// Stream buffer counting the characters written and discarding them
+class CountingStreamBuf final : public std::streambuf
+{
+public:
+    std::uint64_t count = 0;
+
+protected:
+    int_type overflow(int_type ch) override
+    {
+        if (!traits_type::eq_int_type(ch, traits_type::eof())) { ++count; }
+        return traits_type::not_eof(ch);
+    }
+
+    std::streamsize xsputn(const char_type*, std::streamsize size) override
+    {
+        count += static_cast<std::uint64_t>(size);
+        return size;
+    }
+};
+
+TEST(StreamingStatementTest, BigCo)
+{
+    const PlayCatalog catalog{plays};
+    const Invoice invoice{
+        .customer = "BigCo"s,
+        .performances = {
+            {.play_id = "hamlet"s, .audience = 55},
+            {.play_id = "as-like"s, .audience = 35},
+            {.play_id = "othello"s, .audience = 40},
+        }
+    };
+
+    std::ostringstream oss;
+    StreamingStatement streaming{invoice.customer, catalog, oss};
+    EXPECT_EQ(oss.str(), "Statement for BigCo\n"s);
+
+    // each line is written as soon as fed
+    streaming.add(invoice.performances[0]);
+    EXPECT_EQ(oss.str(), "Statement for BigCo\n  Hamlet: $650.00 (55 seats)\n"s);
+
+    streaming.add(std::span{invoice.performances}.subspan(1));
+    EXPECT_EQ(streaming.size(), 3);
+    EXPECT_EQ(streaming.total_amount(), Money{173000});
+    EXPECT_EQ(streaming.volume_credits(), 47);
+
+    streaming.finish();
+    EXPECT_EQ(oss.str(), statement(invoice, plays));
+    EXPECT_THROW(streaming.add(invoice.performances[0]), std::logic_error);
+    EXPECT_THROW(streaming.finish(), std::logic_error);
+}
+
+TEST(StreamingStatementTest, Views)
+{
+    const PlayCatalog catalog{plays};
+
+    const auto buffer = "hamlet,as-like"s;
+    const std::array performances{
+        PerformanceView{.play_id = std::string_view{buffer}.substr(0, 6), .audience = 55},
+        PerformanceView{.play_id = std::string_view{buffer}.substr(7), .audience = 35},
+    };
+
+    std::ostringstream oss;
+    StreamingStatement streaming{"BigCo"sv, catalog, oss};
+    streaming.add(performances);
+    streaming.finish();
+
+    EXPECT_EQ(oss.str(), statement(InvoiceView{.customer = "BigCo"sv, .performances = performances}, plays));
+}
+
+TEST(StreamingStatementTest, Large)
+{
+    const PlayCatalog catalog{plays};
+    const std::array play_ids{"hamlet"sv, "as-like"sv, "othello"sv};
+
+    CountingStreamBuf buf;
+    std::ostream os{&buf};
+    StreamingStatement streaming{"Festival"sv, catalog, os};
+
+    // nothing but the chunk being fed is held
+    constexpr int num_performances = 200'000;
+    std::array<PerformanceView, 1'000> chunk;
+    Money expected_amount;
+    for (int i = 0; i < num_performances; i += std::ssize(chunk)) {
+        for (int j = 0; auto& perf : chunk) {
+            perf = {.play_id = play_ids[static_cast<std::size_t>((i + j) % 3)], .audience = (i + j) % 100};
+            expected_amount += Money{amount_for(catalog.play_for(perf).type, perf.audience)};
+            ++j;
+        }
+        streaming.add(chunk);
+    }
+    streaming.finish();
+
+    EXPECT_TRUE(os);
+    EXPECT_EQ(streaming.size(), num_performances);
+    EXPECT_EQ(streaming.total_amount(), expected_amount);
+    EXPECT_GT(buf.count, 20 * std::uint64_t{num_performances});
+}
+
+TEST(StreamingStatementTest, Errors)
+{
+    const PlayCatalog catalog{plays};
+
+    std::ostringstream oss;
+    StreamingStatement streaming{"BigCo"sv, catalog, oss};
+    const std::array performances{
+        Performance{.play_id = "hamlet"s, .audience = 55},
+        Performance{.play_id = "macbeth"s, .audience = 10},
+    };
+    EXPECT_THAT(
+        [&] { streaming.add(performances); },
+        ThrowsMessage<std::out_of_range>(Eq("macbeth: unknown play ID"s)));
+    // with the lines before written
+    EXPECT_EQ(oss.str(), "Statement for BigCo\n  Hamlet: $650.00 (55 seats)\n"s);
+
+    std::ostringstream failed;
+    failed.setstate(std::ios_base::failbit);
+    StreamingStatement unwritten{"BigCo"sv, catalog, failed};
+    unwritten.add(performances[0]);
+    unwritten.finish();
+    EXPECT_EQ(failed.str(), ""s);
+    EXPECT_EQ(unwritten.size(), 1);
+    EXPECT_EQ(unwritten.total_amount(), Money{65000});
+}
+
+TEST(StreamingStatementTest, Overflow)
+{
+    const PlayCatalog catalog{plays};
+
+    std::ostringstream oss;
+    StreamingStatement streaming{"HugeCo"sv, catalog, oss};
+    // (the lines not written to saturate the total quickly)
+    oss.setstate(std::ios_base::failbit);
+    std::array<PerformanceView, 1'000> chunk;
+    chunk.fill({.play_id = "hamlet"sv, .audience = std::numeric_limits<int>::max()});
+    while (!streaming.total_amount().saturated()) { streaming.add(chunk); }
+    oss.clear();
+
+    // nothing is written and the statement is left unfinished
+    EXPECT_THROW(streaming.finish(), std::overflow_error);
+    EXPECT_EQ(oss.str(), "Statement for HugeCo\n"s);
+    EXPECT_THROW(streaming.finish(), std::overflow_error);
+}
+
+}
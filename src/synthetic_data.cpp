@@ -0,0 +1,89 @@
+#include "pch.h"
+
+#include "synthetic_data.h"
+
+namespace {
+
+// SplitMix64 (Steele et al., 2014), whose output is fully specified unlike that of
+// `std::uniform_int_distribution` and the like
+class Random
+{
+public:
+    explicit Random(std::uint64_t seed) noexcept : state_{seed} {}
+
+    std::uint64_t next() noexcept
+    {
+        auto z = state_ += 0x9E3779B97F4A7C15ull;
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+        return z ^ (z >> 31);
+    }
+
+    // Returns an integer in [0, n) (with negligible bias for `n` far below 2^64).
+    std::uint64_t below(std::uint64_t n) noexcept { return next() % n; }
+
+    // Returns a real number in [0, 1).
+    double unit() noexcept { return static_cast<double>(next() >> 11) * 0x1.0p-53; }
+
+private:
+    std::uint64_t state_;
+};
+
+Play::Type pick_genre(Random& random, std::span<const SyntheticGenre> genres, double total_weight)
+{
+    auto x = random.unit() * total_weight;
+    for (const auto& genre : genres) {
+        if (x < genre.weight) { return genre.type; }
+        x -= genre.weight;
+    }
+    // rounding may leave `x` just short of zero
+    return genres.back().type;
+}
+
+}
+
+SyntheticData make_synthetic_data(const SyntheticOptions& options)
+{
+    if (options.num_plays == 0) { throw std::invalid_argument{"no synthetic plays"s}; }
+    if (options.num_customers == 0) { throw std::invalid_argument{"no synthetic customers"s}; }
+    if (options.max_performances < options.min_performances) {
+        throw std::invalid_argument{"fewer maximum than minimum synthetic performances"s};
+    }
+    auto total_weight = 0.0;
+    for (const auto& genre : options.genres) {
+        if (!(genre.weight >= 0.0)) { throw std::invalid_argument{"negative synthetic genre weight"s}; }
+        total_weight += genre.weight;
+    }
+    if (!(total_weight > 0.0)) { throw std::invalid_argument{"no synthetic genres"s}; }
+
+    Random random{options.seed};
+    SyntheticData data;
+
+    std::vector<std::string> play_ids;
+    play_ids.reserve(options.num_plays);
+    for (std::size_t i = 0; i < options.num_plays; ++i) {
+        play_ids.push_back(std::format("play{}"sv, i));
+        data.plays.try_emplace(
+            play_ids.back(),
+            Play{.name = std::format("Play #{}"sv, i), .type = pick_genre(random, options.genres, total_weight)});
+    }
+
+    const auto performance_range = options.max_performances - options.min_performances + 1;
+    const auto audience_range = static_cast<std::uint64_t>(std::max(options.max_audience, 0)) + 1;
+    data.invoices.reserve(options.num_invoices);
+    for (std::size_t i = 0; i < options.num_invoices; ++i) {
+        auto& invoice = data.invoices.emplace_back(Invoice{
+            .customer = std::format("Customer #{}"sv, random.below(options.num_customers)),
+            .performances = {},
+        });
+        const auto size = options.min_performances + random.below(performance_range);
+        invoice.performances.reserve(size);
+        for (std::size_t j = 0; j < size; ++j) {
+            invoice.performances.push_back({
+                .play_id = play_ids[random.below(options.num_plays)],
+                .audience = static_cast<int>(random.below(audience_range)),
+            });
+        }
+    }
+    return data;
+}
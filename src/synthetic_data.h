@@ -0,0 +1,42 @@
+#pragma once
+
+#include "statement.h"
+
+// Weight of the plays of `type` among those generated (relative to the other genres)
+struct SyntheticGenre
+{
+    Play::Type type;
+    double weight;
+};
+
+struct SyntheticOptions
+{
+    std::size_t num_plays = 100;
+    std::size_t num_customers = 100;
+    std::size_t num_invoices = 1'000;
+    // performances per invoice (inclusive)
+    std::size_t min_performances = 1;
+    std::size_t max_performances = 20;
+    // audience per performance (inclusive)
+    int max_audience = 100;
+    std::vector<SyntheticGenre> genres{
+        {.type = Play::Type::Tragedy, .weight = 1.0},
+        {.type = Play::Type::Comedy, .weight = 1.0},
+    };
+    std::uint64_t seed = 42;
+};
+
+// Catalog and invoices generated at random as `SyntheticOptions` tell
+struct SyntheticData
+{
+    // with IDs "play0", "play1", ... named "Play #0", "Play #1", ...
+    std::map<std::string, Play> plays;
+    // of customers "Customer #0", "Customer #1", ... picked at random (so that most have several)
+    std::vector<Invoice> invoices;
+};
+
+// Generates a catalog and invoices at random but deterministically, i.e., the same for the same
+// `options` on any platform (unlike the distributions of `<random>`), for tests and benchmarks
+// of realistic sizes; throws `std::invalid_argument` if `options` describe no plays,
+// no customers, no genres (of positive weights), or fewer maximum than minimum performances.
+SyntheticData make_synthetic_data(const SyntheticOptions& options);
@@ -0,0 +1,107 @@
+#include "pch.h"
+
+#include "synthetic_data.h"
+
+#include <gtest/gtest.h>
+#include <gmock/gmock.h>
+
+using namespace testing;
+
+namespace {
+
+TEST(SyntheticDataTest, Sizes)
+{
+    const auto data = make_synthetic_data({
+        .num_plays = 10, .num_customers = 5, .num_invoices = 200,
+        .min_performances = 2, .max_performances = 4, .max_audience = 30,
+    });
+
+    ASSERT_EQ(std::size(data.plays), 10);
+    EXPECT_EQ(data.plays.at("play9"s).name, "Play #9"s);
+    ASSERT_EQ(std::size(data.invoices), 200);
+
+    std::set<std::string> customers;
+    std::set<std::size_t> sizes;
+    std::set<int> audiences;
+    for (const auto& invoice : data.invoices) {
+        customers.insert(invoice.customer);
+        sizes.insert(std::size(invoice.performances));
+        for (const auto& perf : invoice.performances) {
+            EXPECT_TRUE(data.plays.contains(perf.play_id));
+            audiences.insert(perf.audience);
+        }
+    }
+    EXPECT_EQ(std::size(customers), 5);
+    EXPECT_THAT(sizes, ElementsAre(2, 3, 4));
+    EXPECT_EQ(*std::cbegin(audiences), 0);
+    EXPECT_EQ(*std::crbegin(audiences), 30);
+}
+
+TEST(SyntheticDataTest, Deterministic)
+{
+    const SyntheticOptions options{.num_plays = 20, .num_invoices = 50};
+    const auto data = make_synthetic_data(options);
+    const auto again = make_synthetic_data(options);
+    auto other_options = options;
+    other_options.seed = 43;
+    const auto other = make_synthetic_data(other_options);
+
+    const auto same_invoices = [](const SyntheticData& x, const SyntheticData& y)
+    {
+        return std::ranges::equal(x.invoices, y.invoices, [](const Invoice& a, const Invoice& b)
+        {
+            return a.customer == b.customer && std::ranges::equal(
+                a.performances, b.performances, [](const Performance& p, const Performance& q)
+                {
+                    return p.play_id == q.play_id && p.audience == q.audience;
+                });
+        });
+    };
+    EXPECT_TRUE(same_invoices(data, again));
+    EXPECT_FALSE(same_invoices(data, other));
+
+    // pinned so that the data stays the same from version to version (and platform to platform)
+    EXPECT_EQ(data.invoices[0].customer, "Customer #72"s);
+    EXPECT_EQ(data.invoices[0].performances[0].play_id, "play5"s);
+}
+
+TEST(SyntheticDataTest, Genres)
+{
+    const auto count_comedies = [](const SyntheticData& data)
+    {
+        return std::ranges::count_if(data.plays, [](const auto& entry)
+        {
+            return entry.second.type == Play::Type::Comedy;
+        });
+    };
+
+    const auto comedies = make_synthetic_data({
+        .num_plays = 100, .num_invoices = 0,
+        .genres = {{.type = Play::Type::Tragedy, .weight = 0.0}, {.type = Play::Type::Comedy, .weight = 1.0}},
+    });
+    EXPECT_EQ(count_comedies(comedies), 100);
+
+    const auto mixed = make_synthetic_data({
+        .num_plays = 1'000, .num_invoices = 0,
+        .genres = {{.type = Play::Type::Tragedy, .weight = 3.0}, {.type = Play::Type::Comedy, .weight = 1.0}},
+    });
+    EXPECT_THAT(count_comedies(mixed), AllOf(Gt(200), Lt(300)));
+
+    const auto unknown = static_cast<Play::Type>(42);
+    const auto custom = make_synthetic_data({
+        .num_plays = 10, .num_invoices = 0, .genres = {{.type = unknown, .weight = 1.0}},
+    });
+    EXPECT_EQ(custom.plays.at("play0"s).type, unknown);
+}
+
+TEST(SyntheticDataTest, Invalid)
+{
+    EXPECT_THROW(make_synthetic_data({.num_plays = 0}), std::invalid_argument);
+    EXPECT_THROW(make_synthetic_data({.num_customers = 0}), std::invalid_argument);
+    EXPECT_THROW(make_synthetic_data({.min_performances = 2, .max_performances = 1}), std::invalid_argument);
+    EXPECT_THROW(make_synthetic_data({.genres = {}}), std::invalid_argument);
+    EXPECT_THROW(
+        make_synthetic_data({.genres = {{.type = Play::Type::Comedy, .weight = -1.0}}}), std::invalid_argument);
+}
+
+}